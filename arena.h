@@ -95,11 +95,13 @@ void* arena_handle(AllocOp op, void* alloc, s32 old_size, s32 size_requested, vo
             if(allocator->curr_offset + size_requested > allocator->size_available) {
                 // resize necessary
                 // COPYPASTE(cogno): this is basically equal to AllocOp::INIT, except for the pointer to the old block, easily compressible
+                // NOTE: the new block is at least as big as the old one, else after the first resize every allocation would get its own block
+                int new_block_size = size_requested > allocator->size_available ? size_requested : allocator->size_available;
                 arena_reset(allocator);
                 auto* old_header = arena_get_header_before_data(allocator->data);
-                new_memory = arena_prepare_new_memory_block(allocator, size_requested, old_header);
+                new_memory = arena_prepare_new_memory_block(allocator, new_block_size, old_header);
                 allocator->data = new_memory;
-                allocator->size_available = size_requested;
+                allocator->size_available = new_block_size;
             }
             
             if(op == AllocOp::REALLOC && ptr_request != NULL) {
@@ -0,0 +1,788 @@
+#pragma once
+#define GYO_BENCHMARK
+
+/*
+In this file:
+- benchmark_run, a statistical benchmark runner. It warms up, decides how many calls to time together (so even
+  functions taking a few nanoseconds are measured precisely), records every sample and reports min, median, p90, p99,
+  max, mean and standard deviation (without the outliers) plus an histogram of the samples
+- BENCHMARK_STATS / BENCHMARK_STATS_VOID, to run it on a function call and print the results
+- benchmark_keep and benchmark_clobber, so the compiler doesn't optimize away the code you're measuring
+- benchmark_run_range, to measure a function on inputs of growing size (built by a setup function, not measured),
+  fit the results to O(1)/O(log n)/O(n)/O(n log n)/O(n^2) and print a scaling table (print_benchmark_scaling)
+- BENCHMARK_REGISTER, to declare benchmarks anywhere and benchmark_main, to run them from the command line with a
+  name filter, saving the results as JSON/CSV and comparing them with the ones of a previous run (a baseline)
+
+Example:
+BENCHMARK_STATS(str_split_left, text, ',');
+
+BenchmarkOptions options = {};
+options.min_seconds = 5;
+BenchmarkResult r = benchmark_run("parse", [&]() { benchmark_keep(json_parse(input, &doc)); json_free(&doc); }, options);
+print_benchmark_result(&r);
+print_benchmark_histogram(&r);
+
+BENCHMARK_REGISTER(json_parse_big) {
+    JsonDocument doc;
+    benchmark_keep(json_parse(big_input, &doc));
+    json_free(&doc);
+}
+int main(int argc, char** argv) { return benchmark_main(argc, argv); }
+// > program --filter=json --json=new.json --baseline=old.json --threshold=3
+
+Array<s32> numbers = {};
+BenchmarkRange range = {};
+range.from = 1 << 4;
+range.to = 1 << 24;
+range.bytes_per_element = sizeof(s32);
+BenchmarkScaling s = benchmark_run_range("array_sum", range,
+    [&](s64 n) { array_free(&numbers); numbers = make_array<s32>((s32)n); for(s64 i = 0; i < n; i++) array_append(&numbers, (s32)i); },
+    [&](s64 n) { s64 sum = 0; for(s32 i = 0; i < numbers.size; i++) sum += numbers[i]; benchmark_keep(sum); });
+print_benchmark_scaling(&s);
+
+Differently from simple_benchmark.h, which only keeps the minimum, here you can see the tail (p90, p99, max) too.
+All the numbers are cycles (of read_cpu_timer) per call, print_benchmark_result also converts them to time.
+Things to know:
+- calls are timed in batches until a batch takes at least min_batch_cycles, so the cost of reading the timer doesn't count.
+  A sample is then the average of the calls in its batch: if you care about the latency of single calls, make sure
+  the batch is 1 (the function is slow enough, or set max_batch to 1)
+- samples farther than outlier_k times the interquartile range (at least 5% of the median) from the first/third quartile are outliers
+  (interrupts, context switches, page faults...) and are not used for the statistics, set it to 0 to keep them all
+*/
+
+#ifndef DISABLE_INCLUDES
+    #include <cmath> // for sqrt, pow and log
+#endif
+
+#ifndef GYOFIRST
+    #include "first.h"
+#endif
+
+#ifndef GYOPERFORMANCE_COUNTER
+    #include "performance_counter.h"
+#endif
+
+#ifndef GYO_ARRAY
+    #include "array.h"
+#endif
+
+#ifndef GYO_SORT
+    #include "sort.h"
+#endif
+
+#ifndef GYO_STR
+    #include "str.h"
+#endif
+
+#ifndef GYO_JSON
+    #include "json.h"
+#endif
+
+#define BENCHMARK_HISTOGRAM_BINS 16
+
+struct BenchmarkOptions {
+    f64 warmup_seconds = 0.1;   // running before measuring, to fill caches, train branch predictors and wake the cpu up
+    f64 min_seconds = 1;        // measure for at least this long...
+    s32 min_samples = 100;      // ...and at least this many samples
+    s32 max_samples = 1000000;
+    u64 min_batch_cycles = 2000;
+    s32 max_batch = 1 << 20;
+    f64 outlier_k = 3;          // 0 keeps every sample
+    u64 bytes_per_call = 0;     // if the function processes some data, to report the GB/s
+};
+
+struct BenchmarkResult {
+    const char* name;
+    s64 calls;    // including the warmup and calibration ones
+    s32 samples;  // used for the statistics
+    s32 outliers; // rejected
+    s32 batch;    // calls per sample
+
+    // cycles per call
+    f64 min;
+    f64 median;
+    f64 p90;
+    f64 p99;
+    f64 max;
+    f64 mean;
+    f64 stddev;
+
+    u64 cpu_frequency;
+    u64 bytes_per_call;
+
+    // how many samples for each bin, bins go from min to max in log scale (so they're all readable)
+    s32 histogram[BENCHMARK_HISTOGRAM_BINS];
+#if HW_COUNTERS
+    HwCounters hw; // over all the measured calls
+#endif
+};
+
+#ifdef _MSC_VER
+// forces the compiler to compute value (and keep it somewhere)
+template<typename T> inline void benchmark_keep(T const& value) { volatile const char* p = (volatile const char*)&value; (void)*p; _ReadWriteBarrier(); }
+// forces the compiler to do every write to memory before this point
+inline void benchmark_clobber() { _ReadWriteBarrier(); }
+#else
+template<typename T> inline void benchmark_keep(T const& value) { asm volatile("" : : "r,m"(value) : "memory"); }
+inline void benchmark_clobber() { asm volatile("" : : : "memory"); }
+#endif
+
+// p from 0 to 1, linearly interpolated between the 2 closest samples
+f64 _benchmark_percentile(f64* sorted, s32 count, f64 p) {
+    f64 position = p * (count - 1);
+    s32 index = (s32)position;
+    if(index >= count - 1) return sorted[count - 1];
+    f64 fraction = position - index;
+    return sorted[index] * (1 - fraction) + sorted[index + 1] * fraction;
+}
+
+void _benchmark_statistics(BenchmarkResult* result, Array<f64>* samples, f64 outlier_k) {
+    array_sort(samples);
+    f64* sorted = samples->ptr;
+    s32 count = samples->size;
+    if(count == 0) return; // nothing measured, everything stays 0
+
+    if(outlier_k > 0 && count >= 4) {
+        f64 q1 = _benchmark_percentile(sorted, count, 0.25);
+        f64 q3 = _benchmark_percentile(sorted, count, 0.75);
+        // very stable functions can have all the samples (almost) equal, so the range is at least 5% of the median
+        f64 spread = q3 - q1;
+        f64 min_spread = _benchmark_percentile(sorted, count, 0.5) * 0.05;
+        if(spread < min_spread) spread = min_spread;
+        f64 low = q1 - outlier_k * spread;
+        f64 high = q3 + outlier_k * spread;
+        s32 first = 0;
+        while(first < count && sorted[first] < low) first++;
+        s32 last = count;
+        while(last > first && sorted[last - 1] > high) last--;
+        result->outliers = count - (last - first);
+        sorted += first;
+        count = last - first;
+    }
+
+    result->samples = count;
+    result->min = sorted[0];
+    result->max = sorted[count - 1];
+    result->median = _benchmark_percentile(sorted, count, 0.5);
+    result->p90 = _benchmark_percentile(sorted, count, 0.9);
+    result->p99 = _benchmark_percentile(sorted, count, 0.99);
+
+    f64 sum = 0;
+    for(s32 i = 0; i < count; i++) sum += sorted[i];
+    result->mean = sum / count;
+    f64 squares = 0;
+    for(s32 i = 0; i < count; i++) squares += (sorted[i] - result->mean) * (sorted[i] - result->mean);
+    result->stddev = count > 1 ? sqrt(squares / (count - 1)) : 0;
+
+    f64 log_min = log(result->min > 0 ? result->min : 1e-9);
+    f64 log_range = log(result->max > 0 ? result->max : 1e-9) - log_min;
+    for(s32 i = 0; i < count; i++) {
+        s32 bin = 0;
+        if(log_range > 0 && sorted[i] > 0) bin = (s32)((log(sorted[i]) - log_min) / log_range * BENCHMARK_HISTOGRAM_BINS);
+        if(bin >= BENCHMARK_HISTOGRAM_BINS) bin = BENCHMARK_HISTOGRAM_BINS - 1;
+        if(bin < 0) bin = 0;
+        result->histogram[bin]++;
+    }
+}
+
+// runs body() many times and measures it, see the top of the file
+template<typename F>
+BenchmarkResult benchmark_run(const char* name, F body, BenchmarkOptions options) {
+    BenchmarkResult result = {};
+    result.name = name;
+    result.bytes_per_call = options.bytes_per_call;
+    result.cpu_frequency = estimate_cpu_frequency(10);
+    u64 os_frequency = get_os_timer_freq();
+
+    // warmup, we use the os timer for the durations (the cpu timer is only for the samples)
+    u64 warmup_end = read_os_timer() + (u64)(options.warmup_seconds * os_frequency);
+    do {
+        body();
+        result.calls++;
+    } while(read_os_timer() < warmup_end);
+
+    // calibration, double the batch until it's long enough
+    s32 batch = 1;
+    while(batch < options.max_batch) {
+        u64 start = read_cpu_timer();
+        for(s32 i = 0; i < batch; i++) body();
+        u64 cycles = read_cpu_timer() - start;
+        result.calls += batch;
+        if(cycles >= options.min_batch_cycles) break;
+        batch *= 2;
+    }
+    if(batch > options.max_batch) batch = options.max_batch;
+    result.batch = batch;
+
+    Array<f64> samples = make_array<f64>(options.min_samples > 0 ? options.min_samples : 1);
+#if HW_COUNTERS
+    HwCounters hw_start = read_hw_counters();
+#endif
+    u64 measure_end = read_os_timer() + (u64)(options.min_seconds * os_frequency);
+    do { // at least 1 sample, whatever the options say
+        u64 start = read_cpu_timer();
+        for(s32 i = 0; i < batch; i++) body();
+        u64 cycles = read_cpu_timer() - start;
+        array_append(&samples, (f64)cycles / batch);
+    } while(samples.size < options.max_samples && (samples.size < options.min_samples || read_os_timer() < measure_end));
+#if HW_COUNTERS
+    result.hw = hw_counters_diff(read_hw_counters(), hw_start);
+#endif
+    result.calls += (s64)samples.size * batch;
+
+    _benchmark_statistics(&result, &samples, options.outlier_k);
+    array_free(&samples);
+    return result;
+}
+
+template<typename F> BenchmarkResult benchmark_run(const char* name, F body) { return benchmark_run(name, body, BenchmarkOptions()); }
+
+// cycles as ns/us/ms/s
+void _benchmark_format_time(char* out, s32 out_size, f64 cycles, u64 cpu_frequency) {
+    f64 time = cycles * 1000000000.0 / cpu_frequency;
+    if(time < 1000) { snprintf(out, out_size, "%.2fns", time); return; }
+    time /= 1000;
+    if(time < 1000) { snprintf(out, out_size, "%.2fus", time); return; }
+    time /= 1000;
+    if(time < 1000) { snprintf(out, out_size, "%.2fms", time); return; }
+    snprintf(out, out_size, "%.2fs", time / 1000);
+}
+
+void print_benchmark_result(BenchmarkResult* r) {
+    print("benchmark '%' x% calls (% samples of % calls, % outliers rejected)", r->name, r->calls, r->samples, r->batch, r->outliers);
+
+    const char* names[] = { "min", "median", "p90", "p99", "max", "mean", "stddev" };
+    f64 values[] = { r->min, r->median, r->p90, r->p99, r->max, r->mean, r->stddev };
+    char line[512];
+    char time[32];
+    s32 size = 0;
+    for(s32 i = 0; i < 7; i++) {
+        _benchmark_format_time(time, sizeof(time), values[i], r->cpu_frequency);
+        size += snprintf(line + size, sizeof(line) - size, "%s%s=%.1f (%s)", i == 0 ? "    " : ", ", names[i], values[i], time);
+    }
+    print("% cycles per call", (const char*)line);
+
+    if(r->bytes_per_call > 0 && r->median > 0) {
+        f64 seconds = r->median / r->cpu_frequency;
+        print("    throughput: % GB/s (median)", r->bytes_per_call / seconds / 1000000000.0);
+    }
+#if HW_COUNTERS
+    printsl("    ");
+    print_hw_counters(r->hw, r->samples * r->batch);
+    print("");
+#endif
+}
+
+// one line per bin, with a bar as long as how many samples it has
+void print_benchmark_histogram(BenchmarkResult* r) {
+    s32 most = 1;
+    for(s32 i = 0; i < BENCHMARK_HISTOGRAM_BINS; i++) if(r->histogram[i] > most) most = r->histogram[i];
+    f64 ratio = r->min > 0 && r->max > r->min ? r->max / r->min : 1;
+    for(s32 i = 0; i < BENCHMARK_HISTOGRAM_BINS; i++) {
+        f64 from = r->min * pow(ratio, (f64)i / BENCHMARK_HISTOGRAM_BINS);
+        f64 to = r->min * pow(ratio, (f64)(i + 1) / BENCHMARK_HISTOGRAM_BINS);
+        char line[128];
+        s32 size = snprintf(line, sizeof(line), "    %12.1f - %12.1f | ", from, to);
+        s32 bar = (s32)(50.0 * r->histogram[i] / most);
+        for(s32 j = 0; j < bar && size < (s32)sizeof(line) - 1; j++) line[size++] = '#';
+        line[size] = 0;
+        print("% %", (const char*)line, r->histogram[i]);
+    }
+}
+
+#define BENCHMARK_STATS(func_name, ...) \
+do { \
+    BenchmarkResult _benchmark_result = benchmark_run(#func_name "(" #__VA_ARGS__ ")", [&]() { benchmark_keep(func_name(__VA_ARGS__)); }); \
+    print_benchmark_result(&_benchmark_result); \
+} while(0)
+
+// alternative to BENCHMARK_STATS for functions returning void
+#define BENCHMARK_STATS_VOID(func_name, ...) \
+do { \
+    BenchmarkResult _benchmark_result = benchmark_run(#func_name "(" #__VA_ARGS__ ")", [&]() { func_name(__VA_ARGS__); benchmark_clobber(); }); \
+    print_benchmark_result(&_benchmark_result); \
+} while(0)
+
+// benchmark_run_range, to see how a function scales with the size of its input
+
+enum BenchmarkComplexity {
+    BIG_O_1,
+    BIG_O_LOG_N,
+    BIG_O_N,
+    BIG_O_N_LOG_N,
+    BIG_O_N_SQUARED,
+    BIG_O_AMT,
+};
+
+const char* BENCHMARK_COMPLEXITY_NAMES[BIG_O_AMT] = { "O(1)", "O(log n)", "O(n)", "O(n log n)", "O(n^2)" };
+
+#define BENCHMARK_MAX_SIZES 64
+
+struct BenchmarkRange {
+    s64 from = 16;
+    s64 to = 1 << 24;
+    s64 multiplier = 2;         // sizes are from, from*multiplier, from*multiplier^2... up to to (included)
+    u64 bytes_per_element = 0;  // to show the working set (and the GB/s) of each size
+};
+
+struct BenchmarkScaling {
+    const char* name;
+    s32 count;
+    s64 sizes[BENCHMARK_MAX_SIZES];
+    BenchmarkResult results[BENCHMARK_MAX_SIZES];
+    u64 bytes_per_element;
+
+    // the best fit of the medians: cycles per call ~= coefficient * f(n)
+    BenchmarkComplexity complexity;
+    f64 coefficient;
+    f64 fit_error; // root mean square of the differences, relative to the medians
+    f64 fit_coefficients[BIG_O_AMT];
+    f64 fit_errors[BIG_O_AMT];
+};
+
+inline f64 _benchmark_complexity(BenchmarkComplexity complexity, f64 n) {
+    switch(complexity) {
+        case BIG_O_1:         return 1;
+        case BIG_O_LOG_N:     return log2(n);
+        case BIG_O_N:         return n;
+        case BIG_O_N_LOG_N:   return n * log2(n);
+        case BIG_O_N_SQUARED: return n * n;
+        default:              return 1;
+    }
+}
+
+// least squares on every complexity, the one with the smallest error wins.
+// The differences are relative to the measured times, otherwise the biggest sizes would be the only ones that matter
+void benchmark_fit_complexity(BenchmarkScaling* s) {
+    if(s->count == 0) return;
+    s->fit_error = -1;
+    for(s32 c = 0; c < BIG_O_AMT; c++) {
+        // minimizes the sum of ((median - coefficient * f) / median)^2
+        f64 f_over_t = 0;
+        f64 f_over_t_squared = 0;
+        for(s32 i = 0; i < s->count; i++) {
+            f64 t = s->results[i].median > 0 ? s->results[i].median : 1e-9;
+            f64 f = _benchmark_complexity((BenchmarkComplexity)c, (f64)s->sizes[i]);
+            f_over_t += f / t;
+            f_over_t_squared += (f / t) * (f / t);
+        }
+        f64 coefficient = f_over_t_squared > 0 ? f_over_t / f_over_t_squared : 0;
+        f64 squares = 0;
+        for(s32 i = 0; i < s->count; i++) {
+            f64 t = s->results[i].median > 0 ? s->results[i].median : 1e-9;
+            f64 difference = (t - coefficient * _benchmark_complexity((BenchmarkComplexity)c, (f64)s->sizes[i])) / t;
+            squares += difference * difference;
+        }
+        f64 error = sqrt(squares / s->count);
+        s->fit_coefficients[c] = coefficient;
+        s->fit_errors[c] = error;
+        if(s->fit_error < 0 || error < s->fit_error) {
+            s->complexity = (BenchmarkComplexity)c;
+            s->coefficient = coefficient;
+            s->fit_error = error;
+        }
+    }
+}
+
+// for each size n calls setup(n) once (not measured), then measures body(n) with benchmark_run.
+// setup builds the input somewhere body can see it (like a variable captured by both lambdas), body has to leave it
+// usable for the next call (sorting an array sorts it only the first time, copy it first if you need to).
+// Bigger inputs are slower, so the default options measure for less time than benchmark_run (see the overload below).
+template<typename S, typename F>
+BenchmarkScaling benchmark_run_range(const char* name, BenchmarkRange range, S setup, F body, BenchmarkOptions options) {
+    ASSERT(range.multiplier >= 2, "the multiplier has to be at least 2, it was %", range.multiplier);
+    ASSERT(range.from >= 1, "sizes start from 1, from was %", range.from);
+    BenchmarkScaling s = {};
+    s.name = name;
+    s.bytes_per_element = range.bytes_per_element;
+    for(s64 n = range.from; n <= range.to && s.count < BENCHMARK_MAX_SIZES; n *= range.multiplier) {
+        setup(n);
+        BenchmarkOptions size_options = options;
+        size_options.bytes_per_call = range.bytes_per_element * n;
+        s.sizes[s.count] = n;
+        s.results[s.count] = benchmark_run(name, [&]() { body(n); }, size_options);
+        s.count++;
+        if(n > range.to / range.multiplier) break; // the next one would overflow
+    }
+    benchmark_fit_complexity(&s);
+    return s;
+}
+
+template<typename S, typename F>
+BenchmarkScaling benchmark_run_range(const char* name, BenchmarkRange range, S setup, F body) {
+    BenchmarkOptions options = {};
+    options.warmup_seconds = 0.02;
+    options.min_seconds = 0.2;
+    options.min_samples = 10;
+    return benchmark_run_range(name, range, setup, body, options);
+}
+
+// bytes as B/KB/MB/GB (powers of 1024, like cache sizes)
+void _benchmark_format_bytes(char* out, s32 out_size, f64 bytes) {
+    const char* units[] = { "B", "KB", "MB", "GB", "TB" };
+    s32 unit = 0;
+    while(bytes >= 1024 && unit < 4) { bytes /= 1024; unit++; }
+    snprintf(out, out_size, unit == 0 ? "%.0f%s" : "%.1f%s", bytes, units[unit]);
+}
+
+// one line per size, "fit" is how far the median is from the best fit. When the median grows more than 25% faster than
+// the fit predicts from the previous size the line is marked with '<', with bytes_per_element you can see if it's
+// the input not fitting in a cache level anymore
+void print_benchmark_scaling(BenchmarkScaling* s) {
+    char line[512];
+    snprintf(line, sizeof(line), "scaling of '%s': best fit %s, %.4g * f(n) cycles, %.1f%% error",
+        s->name, BENCHMARK_COMPLEXITY_NAMES[s->complexity], s->coefficient, s->fit_error * 100);
+    print("%", (const char*)line);
+    for(s32 c = 0; c < BIG_O_AMT; c++) {
+        if(c == s->complexity) continue;
+        snprintf(line, sizeof(line), "    %s would be %.1f%% error", BENCHMARK_COMPLEXITY_NAMES[c], s->fit_errors[c] * 100);
+        print("%", (const char*)line);
+    }
+    snprintf(line, sizeof(line), "    %12s %12s %12s %12s %8s %10s", "n", "working set", "median", "per element", "fit", "GB/s");
+    print("%", (const char*)line);
+    for(s32 i = 0; i < s->count; i++) {
+        BenchmarkResult* r = &s->results[i];
+        s64 n = s->sizes[i];
+        char working_set[32] = "-";
+        char median[32];
+        char per_element[32];
+        char throughput[32] = "-";
+        if(s->bytes_per_element > 0) {
+            _benchmark_format_bytes(working_set, sizeof(working_set), (f64)n * s->bytes_per_element);
+            if(r->median > 0) snprintf(throughput, sizeof(throughput), "%.2f", r->bytes_per_call / (r->median / r->cpu_frequency) / 1000000000.0);
+        }
+        _benchmark_format_time(median, sizeof(median), r->median, r->cpu_frequency);
+        _benchmark_format_time(per_element, sizeof(per_element), r->median / n, r->cpu_frequency);
+        f64 predicted = s->coefficient * _benchmark_complexity(s->complexity, (f64)n);
+        f64 difference = predicted > 0 ? (r->median - predicted) / predicted * 100 : 0;
+        bool jump = false;
+        if(i > 0) {
+            f64 previous = _benchmark_complexity(s->complexity, (f64)s->sizes[i - 1]);
+            f64 expected_growth = previous > 0 ? _benchmark_complexity(s->complexity, (f64)n) / previous : 1;
+            jump = r->median > 1.25 * expected_growth * s->results[i - 1].median;
+        }
+        snprintf(line, sizeof(line), "    %12lld %12s %12s %12s %+7.0f%% %10s%s",
+            (long long)n, working_set, median, per_element, difference, throughput, jump ? " <" : "");
+        print("%", (const char*)line);
+    }
+}
+
+typedef void (*BenchmarkFunction)();
+
+struct BenchmarkEntry {
+    const char* name;
+    BenchmarkFunction function; // a single call, benchmark_run decides how many times to call it
+    u64 bytes_per_call;
+    BenchmarkEntry* next;
+};
+
+// every registered benchmark, in the order they're declared (inside a file, the order between files is up to the linker)
+BenchmarkEntry* _benchmark_first = NULL;
+BenchmarkEntry* _benchmark_last = NULL;
+
+struct _BenchmarkRegistrar {
+    _BenchmarkRegistrar(BenchmarkEntry* entry) {
+        if(_benchmark_last) _benchmark_last->next = entry;
+        else _benchmark_first = entry;
+        _benchmark_last = entry;
+    }
+};
+
+// BENCHMARK_REGISTER(name) { ...code to measure... }
+// the body is a function called over and over, so do the setup outside of it (in globals or statics)
+#define BENCHMARK_REGISTER_BYTES(name, bytes_per_call) \
+    void _benchmark_function_##name(); \
+    BenchmarkEntry _benchmark_entry_##name = { #name, _benchmark_function_##name, (u64)(bytes_per_call), NULL }; \
+    _BenchmarkRegistrar _benchmark_registrar_##name(&_benchmark_entry_##name); \
+    void _benchmark_function_##name()
+
+#define BENCHMARK_REGISTER(name) BENCHMARK_REGISTER_BYTES(name, 0)
+
+// a tiny regex, enough to choose benchmarks by name: characters, '.' (any character), '*', '+' and '?' after a
+// character or a '.', '^' and '$' to anchor at the start/end and '|' between alternatives. No groups or classes.
+// Like grep, it matches anywhere in the name unless it's anchored.
+bool _benchmark_regex_here(const char* re, const char* re_end, const char* text) {
+    if(re == re_end) return true;
+    if(re + 1 < re_end && (re[1] == '*' || re[1] == '+' || re[1] == '?')) {
+        char c = re[0];
+        char op = re[1];
+        if(op == '?') {
+            if(_benchmark_regex_here(re + 2, re_end, text)) return true;
+            return *text != 0 && (c == '.' || *text == c) && _benchmark_regex_here(re + 2, re_end, text + 1);
+        }
+        if(op == '+') {
+            if(*text == 0 || (c != '.' && *text != c)) return false;
+            text++;
+        }
+        do {
+            if(_benchmark_regex_here(re + 2, re_end, text)) return true;
+        } while(*text != 0 && (*text++ == c || c == '.'));
+        return false;
+    }
+    if(re[0] == '$' && re + 1 == re_end) return *text == 0;
+    if(*text != 0 && (re[0] == '.' || re[0] == *text)) return _benchmark_regex_here(re + 1, re_end, text + 1);
+    return false;
+}
+
+bool benchmark_name_matches(const char* pattern, const char* name) {
+    const char* alternative = pattern;
+    while(true) {
+        const char* end = alternative;
+        while(*end != 0 && *end != '|') end++;
+        if(*alternative == '^') {
+            if(_benchmark_regex_here(alternative + 1, end, name)) return true;
+        } else {
+            const char* text = name;
+            do {
+                if(_benchmark_regex_here(alternative, end, text)) return true;
+            } while(*text++ != 0);
+        }
+        if(*end == 0) return false;
+        alternative = end + 1;
+    }
+}
+
+inline f64 _benchmark_to_ns(f64 cycles, u64 cpu_frequency) { return cycles * 1000000000.0 / cpu_frequency; }
+
+// the cycles too, but to compare runs on different machines (or with turbo on/off) use the *_ns ones
+void benchmark_write_json(StrBuilder* b, BenchmarkResult* results, s32 count) {
+    JsonWriter w = make_json_writer(b);
+    json_begin_object(&w);
+    json_write_key(&w, "benchmarks");
+    json_begin_array(&w);
+    for(s32 i = 0; i < count; i++) {
+        BenchmarkResult* r = &results[i];
+        json_begin_object(&w);
+        json_write_key(&w, "name");           json_write(&w, r->name);
+        json_write_key(&w, "calls");          json_write(&w, r->calls);
+        json_write_key(&w, "samples");        json_write(&w, r->samples);
+        json_write_key(&w, "outliers");       json_write(&w, r->outliers);
+        json_write_key(&w, "batch");          json_write(&w, r->batch);
+        json_write_key(&w, "cpu_frequency");  json_write(&w, r->cpu_frequency);
+        json_write_key(&w, "bytes_per_call"); json_write(&w, r->bytes_per_call);
+        const char* names[] = { "min", "median", "p90", "p99", "max", "mean", "stddev" };
+        f64 values[] = { r->min, r->median, r->p90, r->p99, r->max, r->mean, r->stddev };
+        for(s32 j = 0; j < 7; j++) {
+            json_write_key(&w, names[j]);
+            json_write(&w, values[j]);
+        }
+        for(s32 j = 0; j < 7; j++) {
+            char key[32];
+            snprintf(key, sizeof(key), "%s_ns", names[j]);
+            json_write_key(&w, key);
+            json_write(&w, _benchmark_to_ns(values[j], r->cpu_frequency));
+        }
+        json_end_object(&w);
+    }
+    json_end_array(&w);
+    json_end_object(&w);
+}
+
+// one line per benchmark, times in ns
+void benchmark_write_csv(StrBuilder* b, BenchmarkResult* results, s32 count) {
+    str_builder_append(b, "name,calls,samples,outliers,batch,min_ns,median_ns,p90_ns,p99_ns,max_ns,mean_ns,stddev_ns,gb_per_s\n");
+    for(s32 i = 0; i < count; i++) {
+        BenchmarkResult* r = &results[i];
+        u64 f = r->cpu_frequency;
+        f64 gb_per_s = r->bytes_per_call > 0 && r->median > 0 ? r->bytes_per_call / (r->median / f) / 1000000000.0 : 0;
+        char line[512];
+        snprintf(line, sizeof(line), "%s,%lld,%d,%d,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n",
+            r->name, (long long)r->calls, r->samples, r->outliers, r->batch,
+            _benchmark_to_ns(r->min, f), _benchmark_to_ns(r->median, f), _benchmark_to_ns(r->p90, f), _benchmark_to_ns(r->p99, f),
+            _benchmark_to_ns(r->max, f), _benchmark_to_ns(r->mean, f), _benchmark_to_ns(r->stddev, f), gb_per_s);
+        str_builder_append(b, line);
+    }
+}
+
+// "-" is stdout
+bool _benchmark_save(const char* path, StrBuilder* b) {
+    bool is_stdout = path[0] == '-' && path[1] == 0;
+    FILE* file = is_stdout ? stdout : fopen(path, "wb");
+    if(file == NULL) return false;
+    StrBuilderChunk* it = NULL;
+    str chunk;
+    bool ok = true;
+    while(str_builder_next_chunk(b, &it, &chunk)) {
+        if(fwrite(chunk.ptr, 1, chunk.size, file) != (size_t)chunk.size) ok = false;
+    }
+    if(is_stdout) fflush(file);
+    else if(fclose(file) != 0) ok = false;
+    return ok;
+}
+
+// the returned buffer has to be freed with free()
+bool _benchmark_load(const char* path, str* out) {
+    FILE* file = fopen(path, "rb");
+    if(file == NULL) return false;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    u8* buffer = size > 0 ? (u8*)malloc(size) : NULL;
+    bool ok = buffer != NULL && fread(buffer, 1, size, file) == (size_t)size;
+    fclose(file);
+    if(!ok) { free(buffer); return false; }
+    out->ptr = buffer;
+    out->size = (s32)size;
+    return true;
+}
+
+inline void _benchmark_report(FILE* out, const char* line) {
+    if(out == NULL) print("%", line);
+    else fprintf(out, "%s\n", line);
+}
+
+// compares the medians with the ones in baseline_json (written by benchmark_write_json), printing a line for each
+// benchmark (with print, or into out if you give one, like stderr).
+// Slower by more than threshold_percent is a regression, returns how many there are (-1 if the baseline isn't valid)
+s32 benchmark_compare_baseline(BenchmarkResult* results, s32 count, str baseline_json, f64 threshold_percent, FILE* out = NULL) {
+    JsonDocument doc;
+    JsonValue benchmarks;
+    if(!json_parse(baseline_json, &doc)) return -1;
+    if(!json_find(json_root(&doc), "benchmarks", &benchmarks) || json_type(benchmarks) != JsonType::ARRAY) {
+        json_free(&doc);
+        return -1;
+    }
+
+    s32 regressions = 0;
+    char line[512];
+    snprintf(line, sizeof(line), "compared with the baseline (median, regression above +%.1f%%):", threshold_percent);
+    _benchmark_report(out, line);
+    for(s32 i = 0; i < count; i++) {
+        BenchmarkResult* r = &results[i];
+        f64 current = _benchmark_to_ns(r->median, r->cpu_frequency);
+        f64 old = -1;
+        JsonIterator it = json_iterate(benchmarks);
+        JsonValue entry;
+        while(json_next(&it, &entry)) {
+            JsonValue name;
+            JsonValue median;
+            str name_str;
+            if(!json_find(entry, "name", &name) || !json_get_str(name, &name_str)) continue;
+            if(!str_matches(name_str, str(r->name))) continue;
+            if(json_find(entry, "median_ns", &median)) json_get_f64(median, &old);
+            break;
+        }
+
+        char old_time[32];
+        char current_time[32];
+        _benchmark_format_time(current_time, sizeof(current_time), current, 1000000000);
+        if(old <= 0) {
+            snprintf(line, sizeof(line), "    %-40s %12s (new)", r->name, current_time);
+        } else {
+            f64 change = (current - old) / old * 100;
+            const char* verdict = "";
+            if(change > threshold_percent) {
+                verdict = " REGRESSION";
+                regressions++;
+            } else if(change < -threshold_percent) {
+                verdict = " faster";
+            }
+            _benchmark_format_time(old_time, sizeof(old_time), old, 1000000000);
+            snprintf(line, sizeof(line), "    %-40s %12s -> %12s (%+.1f%%)%s", r->name, old_time, current_time, change, verdict);
+        }
+        _benchmark_report(out, line);
+    }
+    json_free(&doc);
+    return regressions;
+}
+
+// "--name=value" -> value
+inline const char* _benchmark_flag(const char* arg, const char* name) {
+    s32 size = (s32)strlen(name);
+    if(strncmp(arg, name, size) != 0 || arg[size] != '=') return NULL;
+    return arg + size + 1;
+}
+
+// runs the registered benchmarks, returns 0 if everything went fine, 1 if there were regressions or errors.
+// --filter=regex          only the benchmarks with a matching name (see benchmark_name_matches)
+// --list                  prints the names without running them
+// --json=path --csv=path  saves the results ("-" is stdout)
+// --baseline=path         compares with the results saved (with --json) by a previous run
+// --threshold=percent     how much slower than the baseline is a regression (default 5)
+// --min-seconds=s --warmup=s --min-samples=n --max-batch=n, see BenchmarkOptions
+// --histogram             prints the histogram of each benchmark too
+int benchmark_main(int argc, char** argv) {
+    const char* filter = NULL;
+    const char* json_path = NULL;
+    const char* csv_path = NULL;
+    const char* baseline_path = NULL;
+    f64 threshold = 5;
+    bool list = false;
+    bool histogram = false;
+    BenchmarkOptions options = {};
+
+    for(s32 i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value;
+        if((value = _benchmark_flag(arg, "--filter")))           filter = value;
+        else if((value = _benchmark_flag(arg, "--json")))        json_path = value;
+        else if((value = _benchmark_flag(arg, "--csv")))         csv_path = value;
+        else if((value = _benchmark_flag(arg, "--baseline")))    baseline_path = value;
+        else if((value = _benchmark_flag(arg, "--threshold")))   threshold = atof(value);
+        else if((value = _benchmark_flag(arg, "--min-seconds"))) options.min_seconds = atof(value);
+        else if((value = _benchmark_flag(arg, "--warmup")))      options.warmup_seconds = atof(value);
+        else if((value = _benchmark_flag(arg, "--min-samples"))) options.min_samples = atoi(value);
+        else if((value = _benchmark_flag(arg, "--max-batch")))   options.max_batch = atoi(value);
+        else if(strcmp(arg, "--list") == 0)                      list = true;
+        else if(strcmp(arg, "--histogram") == 0)                 histogram = true;
+        else {
+            print("unknown argument '%', the options are --filter= --list --json= --csv= --baseline= --threshold= --min-seconds= --warmup= --min-samples= --max-batch= --histogram", arg);
+            return 1;
+        }
+    }
+    // the results go to stdout, so everything else has to go somewhere else
+    bool quiet = (json_path && strcmp(json_path, "-") == 0) || (csv_path && strcmp(csv_path, "-") == 0);
+
+    Array<BenchmarkResult> results = make_array<BenchmarkResult>(16);
+    for(BenchmarkEntry* entry = _benchmark_first; entry != NULL; entry = entry->next) {
+        if(filter && !benchmark_name_matches(filter, entry->name)) continue;
+        if(list) {
+            print("%", entry->name);
+            continue;
+        }
+        BenchmarkOptions entry_options = options;
+        entry_options.bytes_per_call = entry->bytes_per_call;
+        BenchmarkResult r = benchmark_run(entry->name, entry->function, entry_options);
+        if(!quiet) {
+            print_benchmark_result(&r);
+            if(histogram) print_benchmark_histogram(&r);
+        }
+        array_append(&results, r);
+    }
+
+    int exit_code = 0;
+    if(json_path || csv_path) {
+        for(s32 i = 0; i < 2; i++) {
+            const char* path = i == 0 ? json_path : csv_path;
+            if(path == NULL) continue;
+            StrBuilder b = make_str_builder();
+            if(i == 0) benchmark_write_json(&b, results.ptr, results.size);
+            else benchmark_write_csv(&b, results.ptr, results.size);
+            if(!_benchmark_save(path, &b)) {
+                fprintf(stderr, "can't write the results to %s\n", path);
+                exit_code = 1;
+            }
+            str_builder_free(&b);
+        }
+    }
+
+    if(baseline_path && !list) {
+        str baseline;
+        s32 regressions = -1;
+        if(_benchmark_load(baseline_path, &baseline)) {
+            regressions = benchmark_compare_baseline(results.ptr, results.size, baseline, threshold, quiet ? stderr : NULL);
+            free(baseline.ptr);
+        }
+        if(regressions < 0) {
+            fprintf(stderr, "can't read the baseline %s\n", baseline_path);
+            exit_code = 1;
+        } else if(regressions > 0) {
+            if(quiet) fprintf(stderr, "%d regression(s)\n", regressions);
+            else print("% regression(s)", regressions);
+            exit_code = 1;
+        }
+    }
+
+    array_free(&results);
+    return exit_code;
+}
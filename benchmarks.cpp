@@ -0,0 +1,642 @@
+/*
+In this file:
+The benchmarks of GyoUtils itself, each one next to the std (or plain C) way of doing the same thing,
+so we can check that what we say in the README (faster than std) is still true, and notice when it stops being true.
+- Array append, insert and remove          vs std::vector
+- HashMap insert and find at different load factors (elements per slot of the fixed table) vs std::unordered_map
+- the alloc/free pattern of each allocator vs malloc/free
+- str_split_*, str_trim, the StrParser parse functions, StrBuilder appends vs std::string, strtoull/strtod and snprintf
+- print                                    vs snprintf (both without the cost of writing to the console)
+- vec4, mat4 and rotor math                vs the same math on plain floats (std has no vectors, matrices or quaternions)
+Each pair is named <thing>_gyo and <thing>_std, so they're printed one after the other.
+
+Build it with optimizations, like you would your program, for example:
+cl /O2 /std:c++17 /EHsc benchmarks.cpp
+then run it, it takes the arguments of benchmark_main (see benchmark.h):
+benchmarks.exe                                  runs everything
+benchmarks.exe --filter=hashmap                 only the hashmap ones
+benchmarks.exe --json=baseline.json             saves the results...
+benchmarks.exe --baseline=baseline.json         ...to compare them after a change (exits with 1 on regressions)
+*/
+
+// the std headers come first, after first.h they would see our min/max macros
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "gyoutils.h"
+
+#define INPUT_SIZE 4096
+
+// every input is built in setup_inputs (before any benchmark runs), so the bodies only have what we measure
+s64 keys[INPUT_SIZE];
+s32 allocation_sizes[64];
+std::string csv_line_std;
+str csv_line;
+std::string text_std;
+str text;
+std::string padded_std;
+str padded;
+std::string integers_std;
+str integers;
+std::string floats_std;
+str floats;
+vec4 vectors[1024];
+f32 vectors_plain[1024][4];
+mat4 matrices[64];
+f32 matrices_plain[64][16];
+rotor rotors[256];
+vec3 points[256];
+
+// ARRAY
+
+Array<s32> array_target = {};
+std::vector<s32> vector_target;
+
+BENCHMARK_REGISTER_BYTES(array_append_gyo, INPUT_SIZE * sizeof(s32)) {
+    array_clear(&array_target);
+    for(s32 i = 0; i < INPUT_SIZE; i++) array_append(&array_target, i);
+    benchmark_keep(array_target.ptr[array_target.size - 1]);
+}
+
+BENCHMARK_REGISTER_BYTES(array_append_std, INPUT_SIZE * sizeof(s32)) {
+    vector_target.clear();
+    for(s32 i = 0; i < INPUT_SIZE; i++) vector_target.push_back(i);
+    benchmark_keep(vector_target.back());
+}
+
+// starting from an empty array, so we measure the growth too
+BENCHMARK_REGISTER(array_append_grow_gyo) {
+    Array<s32> a = make_array<s32>(8);
+    for(s32 i = 0; i < INPUT_SIZE; i++) array_append(&a, i);
+    benchmark_keep(a.ptr[a.size - 1]);
+    array_free(&a);
+}
+
+BENCHMARK_REGISTER(array_append_grow_std) {
+    std::vector<s32> v;
+    for(s32 i = 0; i < INPUT_SIZE; i++) v.push_back(i);
+    benchmark_keep(v.back());
+}
+
+// insert and remove in the middle of INPUT_SIZE elements, the size doesn't change between calls
+BENCHMARK_REGISTER(array_insert_remove_gyo) {
+    if(array_target.size != INPUT_SIZE) {
+        array_clear(&array_target);
+        for(s32 i = 0; i < INPUT_SIZE; i++) array_append(&array_target, i);
+    }
+    array_insert(&array_target, 7, INPUT_SIZE / 2);
+    array_remove_at(&array_target, INPUT_SIZE / 3);
+    benchmark_keep(array_target.ptr[INPUT_SIZE / 2]);
+}
+
+BENCHMARK_REGISTER(array_insert_remove_std) {
+    if(vector_target.size() != INPUT_SIZE) {
+        vector_target.clear();
+        for(s32 i = 0; i < INPUT_SIZE; i++) vector_target.push_back(i);
+    }
+    vector_target.insert(vector_target.begin() + INPUT_SIZE / 2, 7);
+    vector_target.erase(vector_target.begin() + INPUT_SIZE / 3);
+    benchmark_keep(vector_target[INPUT_SIZE / 2]);
+}
+
+// HASHMAP
+
+// the HashMap table doesn't grow, the load factor is how many elements we put for each slot of it.
+// std::unordered_map grows to keep its load factor under max_load_factor, so we give it the same one.
+#define HASHMAP_BENCHMARKS(name, load_factor) \
+HashMap<s64, s64> _find_map_##name = {}; \
+std::unordered_map<s64, s64> _find_map_std_##name; \
+BENCHMARK_REGISTER(hashmap_insert_##name##_gyo) { \
+    HashMap<s64, s64> map = make_hashmap<s64, s64>((s32)(INPUT_SIZE / (load_factor))); \
+    for(s32 i = 0; i < INPUT_SIZE; i++) map_insert(&map, keys[i], (s64)i); \
+    benchmark_keep(map.solver.size); \
+    map_free(&map); \
+} \
+BENCHMARK_REGISTER(hashmap_insert_##name##_std) { \
+    std::unordered_map<s64, s64> map; \
+    map.max_load_factor(load_factor); \
+    for(s32 i = 0; i < INPUT_SIZE; i++) map[keys[i]] = i; \
+    benchmark_keep(map.size()); \
+} \
+BENCHMARK_REGISTER(hashmap_find_##name##_gyo) { \
+    if(_find_map_##name.matrix_ptr == NULL) { \
+        _find_map_##name = make_hashmap<s64, s64>((s32)(INPUT_SIZE / (load_factor))); \
+        for(s32 i = 0; i < INPUT_SIZE; i += 2) map_insert(&_find_map_##name, keys[i], (s64)i); \
+    } \
+    s64 sum = 0; \
+    for(s32 i = 0; i < INPUT_SIZE; i++) { /* half of them are not there */ \
+        s64 value; \
+        if(map_find(&_find_map_##name, keys[i], &value)) sum += value; \
+    } \
+    benchmark_keep(sum); \
+} \
+BENCHMARK_REGISTER(hashmap_find_##name##_std) { \
+    if(_find_map_std_##name.empty()) { \
+        _find_map_std_##name.max_load_factor(load_factor); \
+        for(s32 i = 0; i < INPUT_SIZE; i += 2) _find_map_std_##name[keys[i]] = i; \
+    } \
+    s64 sum = 0; \
+    for(s32 i = 0; i < INPUT_SIZE; i++) { \
+        auto found = _find_map_std_##name.find(keys[i]); \
+        if(found != _find_map_std_##name.end()) sum += found->second; \
+    } \
+    benchmark_keep(sum); \
+}
+
+HASHMAP_BENCHMARKS(load_0_5, 0.5f)
+HASHMAP_BENCHMARKS(load_1, 1.0f)
+HASHMAP_BENCHMARKS(load_2, 2.0f)
+HASHMAP_BENCHMARKS(load_4, 4.0f)
+
+// ALLOCATORS
+
+// 64 allocations of different sizes, then every one is freed in the way each allocator likes the most
+BENCHMARK_REGISTER(alloc_free_std) {
+    void* blocks[64];
+    for(s32 i = 0; i < 64; i++) blocks[i] = malloc(allocation_sizes[i]);
+    benchmark_clobber();
+    for(s32 i = 63; i >= 0; i--) free(blocks[i]);
+}
+
+BENCHMARK_REGISTER(alloc_free_default_gyo) {
+    void* blocks[64];
+    for(s32 i = 0; i < 64; i++) blocks[i] = mem_alloc(default_allocator, allocation_sizes[i]);
+    benchmark_clobber();
+    for(s32 i = 63; i >= 0; i--) mem_free(default_allocator, blocks[i], allocation_sizes[i]);
+}
+
+Arena arena = {};
+Allocator arena_allocator = {};
+BENCHMARK_REGISTER(alloc_free_arena_gyo) {
+    if(arena_allocator.data == NULL) {
+        arena = make_arena_allocator(1024 * 1024);
+        arena_allocator = make_allocator(&arena);
+    }
+    for(s32 i = 0; i < 64; i++) benchmark_keep(mem_alloc(arena_allocator, allocation_sizes[i]));
+    benchmark_clobber();
+    arena_reset(&arena); // mem_free_all would give the memory back to the os, we want to reuse it
+}
+
+Allocator fbump_allocator = {};
+BENCHMARK_REGISTER(alloc_free_fbump_gyo) {
+    if(fbump_allocator.data == NULL) fbump_allocator = make_fbump_allocator(1024 * 1024);
+    for(s32 i = 0; i < 64; i++) benchmark_keep(mem_alloc(fbump_allocator, allocation_sizes[i]));
+    benchmark_clobber();
+    mem_free_all(fbump_allocator);
+}
+
+// the circular allocator frees in the same order of the allocations (like a queue)
+Circular circular = {};
+Allocator circular_allocator = {};
+BENCHMARK_REGISTER(alloc_free_circular_gyo) {
+    if(circular_allocator.data == NULL) circular_allocator = make_allocator(&circular, 1024 * 1024);
+    void* blocks[64];
+    for(s32 i = 0; i < 64; i++) blocks[i] = mem_alloc(circular_allocator, allocation_sizes[i]);
+    benchmark_clobber();
+    for(s32 i = 0; i < 64; i++) mem_free(circular_allocator, blocks[i], allocation_sizes[i]);
+}
+
+BENCHMARK_REGISTER(alloc_free_queue_std) {
+    void* blocks[64];
+    for(s32 i = 0; i < 64; i++) blocks[i] = malloc(allocation_sizes[i]);
+    benchmark_clobber();
+    for(s32 i = 0; i < 64; i++) free(blocks[i]);
+}
+
+// STRINGS
+
+BENCHMARK_REGISTER(str_split_left_char_gyo) {
+    str rest = csv_line;
+    str field;
+    s32 total = 0;
+    while(str_split_left(rest, ',', &field, &rest)) total += field.size;
+    total += rest.size;
+    benchmark_keep(total);
+}
+
+BENCHMARK_REGISTER(str_split_left_char_std) {
+    size_t start = 0;
+    s32 total = 0;
+    while(true) {
+        size_t comma = csv_line_std.find(',', start);
+        std::string field = csv_line_std.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        total += (s32)field.size();
+        if(comma == std::string::npos) break;
+        start = comma + 1;
+    }
+    benchmark_keep(total);
+}
+
+BENCHMARK_REGISTER(str_split_left_str_gyo) {
+    str rest = csv_line;
+    str field;
+    s32 total = 0;
+    while(str_split_left(rest, str(", "), &field, &rest)) total += field.size;
+    total += rest.size;
+    benchmark_keep(total);
+}
+
+BENCHMARK_REGISTER(str_split_left_str_std) {
+    size_t start = 0;
+    s32 total = 0;
+    while(true) {
+        size_t found = csv_line_std.find(", ", start);
+        std::string field = csv_line_std.substr(start, found == std::string::npos ? std::string::npos : found - start);
+        total += (s32)field.size();
+        if(found == std::string::npos) break;
+        start = found + 2;
+    }
+    benchmark_keep(total);
+}
+
+BENCHMARK_REGISTER(str_split_right_gyo) {
+    str rest = csv_line;
+    str field;
+    s32 total = 0;
+    while(str_split_right(rest, ',', &rest, &field)) total += field.size;
+    benchmark_keep(total);
+}
+
+BENCHMARK_REGISTER(str_split_right_std) {
+    std::string rest = csv_line_std;
+    s32 total = 0;
+    while(true) {
+        size_t comma = rest.rfind(',');
+        if(comma == std::string::npos) break;
+        total += (s32)rest.substr(comma + 1).size();
+        rest.resize(comma);
+    }
+    benchmark_keep(total);
+}
+
+BENCHMARK_REGISTER(str_split_newline_gyo) {
+    str rest = text;
+    str line;
+    s32 total = 0;
+    while(str_split_newline_left(rest, &line, &rest)) total += line.size;
+    benchmark_keep(total);
+}
+
+BENCHMARK_REGISTER(str_split_newline_std) {
+    size_t start = 0;
+    s32 total = 0;
+    while(true) {
+        size_t newline = text_std.find('\n', start);
+        if(newline == std::string::npos) break;
+        std::string line = text_std.substr(start, newline - start);
+        if(!line.empty() && line.back() == '\r') line.pop_back();
+        total += (s32)line.size();
+        start = newline + 1;
+    }
+    benchmark_keep(total);
+}
+
+BENCHMARK_REGISTER(str_trim_gyo) {
+    str trimmed = str_trim(padded);
+    benchmark_keep(trimmed.size);
+}
+
+BENCHMARK_REGISTER(str_trim_std) {
+    size_t first = padded_std.find_first_not_of(" \t\r\n\v\f");
+    size_t last = padded_std.find_last_not_of(" \t\r\n\v\f");
+    std::string trimmed = first == std::string::npos ? std::string() : padded_std.substr(first, last - first + 1);
+    benchmark_keep(trimmed.size());
+}
+
+BENCHMARK_REGISTER(str_parser_parse_u64_gyo) {
+    StrParser p = make_str_parser(integers);
+    u64 sum = 0;
+    u64 value;
+    while(str_parser_parse_u64(&p, &value)) {
+        sum += value;
+        str_parser_maybe_consume(&p, ' ');
+    }
+    benchmark_keep(sum);
+}
+
+BENCHMARK_REGISTER(str_parser_parse_u64_std) {
+    const char* at = integers_std.c_str();
+    char* end;
+    u64 sum = 0;
+    while(*at != 0) {
+        sum += strtoull(at, &end, 10);
+        if(end == at) break; // only spaces left
+        at = end;
+    }
+    benchmark_keep(sum);
+}
+
+BENCHMARK_REGISTER(str_parser_parse_s64_gyo) {
+    StrParser p = make_str_parser(integers);
+    s64 sum = 0;
+    s64 value;
+    while(str_parser_parse_s64(&p, &value)) {
+        sum += value;
+        str_parser_maybe_consume(&p, ' ');
+    }
+    benchmark_keep(sum);
+}
+
+BENCHMARK_REGISTER(str_parser_parse_s64_std) {
+    const char* at = integers_std.c_str();
+    char* end;
+    s64 sum = 0;
+    while(*at != 0) {
+        sum += strtoll(at, &end, 10);
+        if(end == at) break; // only spaces left
+        at = end;
+    }
+    benchmark_keep(sum);
+}
+
+BENCHMARK_REGISTER(str_parser_parse_s32_gyo) {
+    StrParser p = make_str_parser(integers);
+    s64 sum = 0;
+    s32 value;
+    while(str_parser_parse_s32(&p, &value)) {
+        sum += value;
+        str_parser_maybe_consume(&p, ' ');
+    }
+    benchmark_keep(sum);
+}
+
+BENCHMARK_REGISTER(str_parser_parse_s32_std) {
+    const char* at = integers_std.c_str();
+    char* end;
+    s64 sum = 0;
+    while(*at != 0) {
+        sum += (s32)strtol(at, &end, 10);
+        if(end == at) break; // only spaces left
+        at = end;
+    }
+    benchmark_keep(sum);
+}
+
+BENCHMARK_REGISTER(str_parser_parse_f64_gyo) {
+    StrParser p = make_str_parser(floats);
+    f64 sum = 0;
+    f64 value;
+    while(str_parser_parse_f64(&p, &value)) {
+        sum += value;
+        str_parser_maybe_consume(&p, ' ');
+    }
+    benchmark_keep(sum);
+}
+
+BENCHMARK_REGISTER(str_parser_parse_f64_std) {
+    const char* at = floats_std.c_str();
+    char* end;
+    f64 sum = 0;
+    while(*at != 0) {
+        sum += strtod(at, &end);
+        if(end == at) break; // only spaces left
+        at = end;
+    }
+    benchmark_keep(sum);
+}
+
+BENCHMARK_REGISTER(str_parser_parse_f32_gyo) {
+    StrParser p = make_str_parser(floats);
+    f32 sum = 0;
+    f32 value;
+    while(str_parser_parse_f32(&p, &value)) {
+        sum += value;
+        str_parser_maybe_consume(&p, ' ');
+    }
+    benchmark_keep(sum);
+}
+
+BENCHMARK_REGISTER(str_parser_parse_f32_std) {
+    const char* at = floats_std.c_str();
+    char* end;
+    f32 sum = 0;
+    while(*at != 0) {
+        sum += strtof(at, &end);
+        if(end == at) break; // only spaces left
+        at = end;
+    }
+    benchmark_keep(sum);
+}
+
+BENCHMARK_REGISTER(str_parser_parse_bool_gyo) {
+    StrParser p = make_str_parser(str("true false true true false"));
+    s32 count = 0;
+    bool value;
+    while(str_parser_parse_bool(&p, &value)) {
+        count += value;
+        str_parser_maybe_consume(&p, ' ');
+    }
+    benchmark_keep(count);
+}
+
+BENCHMARK_REGISTER(str_parser_parse_bool_std) {
+    const char* at = "true false true true false";
+    s32 count = 0;
+    while(*at != 0) {
+        if(strncmp(at, "true", 4) == 0) { count++; at += 4; }
+        else if(strncmp(at, "false", 5) == 0) at += 5;
+        else break;
+        if(*at == ' ') at++;
+    }
+    benchmark_keep(count);
+}
+
+StrBuilder builder_target = {};
+std::string string_target;
+
+BENCHMARK_REGISTER(str_builder_append_gyo) {
+    if(builder_target.ptr == NULL) builder_target = make_str_builder();
+    str_builder_clear(&builder_target);
+    for(s32 i = 0; i < 256; i++) {
+        str_builder_append(&builder_target, "value ");
+        str_builder_append(&builder_target, i);
+        str_builder_append(&builder_target, '\n');
+    }
+    benchmark_keep(builder_target.size);
+}
+
+BENCHMARK_REGISTER(str_builder_append_std) {
+    string_target.clear();
+    for(s32 i = 0; i < 256; i++) {
+        string_target += "value ";
+        string_target += std::to_string(i);
+        string_target += '\n';
+    }
+    benchmark_keep(string_target.size());
+}
+
+// PRINT
+
+// print goes through the print sink (the same logger.h uses) so we don't measure the console, just like snprintf
+void _discard_output(const char* data, int size) { benchmark_keep(data[size - 1]); }
+
+BENCHMARK_REGISTER(print_gyo) {
+    auto old_sink = __print.sink;
+    __print.sink = _discard_output;
+    print("benchmark % of %: % cycles (% ms)", 12, 345, 678901u, 2.5);
+    __print.sink = old_sink;
+}
+
+char print_buffer[256];
+BENCHMARK_REGISTER(print_std) {
+    s32 written = snprintf(print_buffer, sizeof(print_buffer), "benchmark %d of %d: %u cycles (%.5f ms)\n", 12, 345, 678901u, 2.5);
+    benchmark_keep(written);
+    benchmark_clobber();
+}
+
+// MATH
+
+BENCHMARK_REGISTER(vec4_multiply_add_gyo) {
+    vec4 total = {};
+    for(s32 i = 0; i < 1024; i++) total += vectors[i] * vectors[1023 - i] + vectors[i];
+    benchmark_keep(total);
+}
+
+BENCHMARK_REGISTER(vec4_multiply_add_std) {
+    f32 total[4] = {};
+    for(s32 i = 0; i < 1024; i++) {
+        for(s32 j = 0; j < 4; j++) total[j] += vectors_plain[i][j] * vectors_plain[1023 - i][j] + vectors_plain[i][j];
+    }
+    benchmark_keep(total);
+}
+
+BENCHMARK_REGISTER(vec4_dot_gyo) {
+    f32 total = 0;
+    for(s32 i = 0; i < 1024; i++) total += vec4_dot(vectors[i], vectors[1023 - i]);
+    benchmark_keep(total);
+}
+
+BENCHMARK_REGISTER(vec4_dot_std) {
+    f32 total = 0;
+    for(s32 i = 0; i < 1024; i++) {
+        for(s32 j = 0; j < 4; j++) total += vectors_plain[i][j] * vectors_plain[1023 - i][j];
+    }
+    benchmark_keep(total);
+}
+
+BENCHMARK_REGISTER(mat4_multiply_gyo) {
+    mat4 total = mat4_new(1);
+    for(s32 i = 0; i < 64; i++) total = total * matrices[i];
+    benchmark_keep(total);
+}
+
+BENCHMARK_REGISTER(mat4_multiply_std) {
+    f32 total[16] = { 1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1 };
+    for(s32 m = 0; m < 64; m++) {
+        f32 result[16];
+        for(s32 row = 0; row < 4; row++) {
+            for(s32 column = 0; column < 4; column++) {
+                f32 sum = 0;
+                for(s32 k = 0; k < 4; k++) sum += total[row * 4 + k] * matrices_plain[m][k * 4 + column];
+                result[row * 4 + column] = sum;
+            }
+        }
+        memcpy(total, result, sizeof(total));
+    }
+    benchmark_keep(total);
+}
+
+BENCHMARK_REGISTER(mat4_vec4_multiply_gyo) {
+    vec4 total = {};
+    for(s32 i = 0; i < 1024; i++) total += matrices[i % 64] * vectors[i];
+    benchmark_keep(total);
+}
+
+BENCHMARK_REGISTER(mat4_vec4_multiply_std) {
+    f32 total[4] = {};
+    for(s32 i = 0; i < 1024; i++) {
+        f32* m = matrices_plain[i % 64];
+        for(s32 row = 0; row < 4; row++) {
+            f32 sum = 0;
+            for(s32 k = 0; k < 4; k++) sum += m[row * 4 + k] * vectors_plain[i][k];
+            total[row] += sum;
+        }
+    }
+    benchmark_keep(total);
+}
+
+BENCHMARK_REGISTER(rotor_rotate_gyo) {
+    vec3 total = {};
+    for(s32 i = 0; i < 256; i++) {
+        vec3 rotated = vec3_rotate(points[i], rotors[i]);
+        total.x += rotated.x; total.y += rotated.y; total.z += rotated.z;
+    }
+    benchmark_keep(total);
+}
+
+// the usual quaternion rotation, v + 2w(q x v) + 2q x (q x v)
+BENCHMARK_REGISTER(rotor_rotate_std) {
+    f32 total[3] = {};
+    for(s32 i = 0; i < 256; i++) {
+        // the same rotation as a quaternion, the bivector is its imaginary part
+        f32 w = rotors[i].s;
+        f32 qx = rotors[i].bivec.yz, qy = rotors[i].bivec.zx, qz = rotors[i].bivec.xy;
+        f32 vx = points[i].x, vy = points[i].y, vz = points[i].z;
+        f32 tx = 2 * (qy * vz - qz * vy), ty = 2 * (qz * vx - qx * vz), tz = 2 * (qx * vy - qy * vx);
+        total[0] += vx + w * tx + (qy * tz - qz * ty);
+        total[1] += vy + w * ty + (qz * tx - qx * tz);
+        total[2] += vz + w * tz + (qx * ty - qy * tx);
+    }
+    benchmark_keep(total);
+}
+
+BENCHMARK_REGISTER(rotor_combine_gyo) {
+    rotor total = rotors[0];
+    for(s32 i = 1; i < 256; i++) total = rotor_combine(total, rotors[i]);
+    benchmark_keep(total);
+}
+
+void setup_inputs() {
+    u64 random = 0x9E3779B97F4A7C15;
+    auto next_random = [&]() { random ^= random << 13; random ^= random >> 7; random ^= random << 17; return random; };
+
+    for(s32 i = 0; i < INPUT_SIZE; i++) keys[i] = (s64)(next_random() >> 1) | 1; // never 0
+    for(s32 i = 0; i < 64; i++) allocation_sizes[i] = 16 + (s32)(next_random() % 1024);
+
+    for(s32 i = 0; i < 256; i++) {
+        if(i > 0) csv_line_std += ", ";
+        csv_line_std += "field" + std::to_string(next_random() % 100000);
+    }
+    for(s32 i = 0; i < 512; i++) text_std += "a line of text number " + std::to_string(i) + (i % 2 ? "\r\n" : "\n");
+    padded_std = std::string(64, ' ') + "some text in the middle of a lot of spaces" + std::string(64, '\t');
+    for(s32 i = 0; i < 1024; i++) integers_std += std::to_string(next_random() % 1000000000) + " ";
+    for(s32 i = 0; i < 1024; i++) {
+        char number[64];
+        snprintf(number, sizeof(number), "%.6f ", (f64)(next_random() % 10000000) / 1000.0);
+        floats_std += number;
+    }
+    // the std::string outlive every benchmark, so the str can point inside them
+    csv_line = str((u8*)csv_line_std.data(), (s32)csv_line_std.size());
+    text = str((u8*)text_std.data(), (s32)text_std.size());
+    padded = str((u8*)padded_std.data(), (s32)padded_std.size());
+    integers = str((u8*)integers_std.data(), (s32)integers_std.size());
+    floats = str((u8*)floats_std.data(), (s32)floats_std.size());
+
+    for(s32 i = 0; i < 1024; i++) {
+        for(s32 j = 0; j < 4; j++) {
+            f32 value = (f32)(next_random() % 2000) / 1000.0f - 1.0f;
+            vectors[i].ptr[j] = value;
+            vectors_plain[i][j] = value;
+        }
+    }
+    for(s32 i = 0; i < 64; i++) {
+        for(s32 j = 0; j < 16; j++) {
+            f32 value = (f32)(next_random() % 2000) / 2000.0f - 0.5f;
+            matrices[i].ptr[j] = value;
+            matrices_plain[i][j] = value;
+        }
+    }
+    for(s32 i = 0; i < 256; i++) {
+        vec3 axis = { (f32)(next_random() % 1000) + 1.0f, (f32)(next_random() % 1000), (f32)(next_random() % 1000) };
+        rotors[i] = rotor_from_axis_angle(axis, (f32)(next_random() % 1000) / 1000.0f); // in turns
+        points[i] = { (f32)(next_random() % 100), (f32)(next_random() % 100), (f32)(next_random() % 100) };
+    }
+}
+
+int main(int argc, char** argv) {
+    setup_inputs();
+    return benchmark_main(argc, argv);
+}
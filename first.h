@@ -10,17 +10,33 @@ In this file:
 - MSVC_BUG macro to automatically fix a msvc compiler bug related to macros
 - custom print replacement to printf, can be used to also print more complex custom types
 - printsl, like print but without \n at the end
+- PRINT and PRINTSL macros, like print and printsl but the format string is parsed at compile time
+- print_set_flush_policy, print_set_buffer_size and print_set_output_fd to batch prints in less (and cheaper) writes
+- per-thread print buffers (printing from many threads is safe), with optional sequence stamps (print_set_sequence_stamps)
 - ASSERT macro which can be deactivated, prints a custom (optional) formatted message and returns the expression value
 - ASSERT_BOUNDS to make out of bounds checks easier
 - EXPECT macro, a quicker way to write single ASSERT checks with error message
 - defer macro, like golang's defer
 - For macro to provide a more convenient way to iterate over Array and similar structs
+- ENUM and ENUM_FLAGS macros, enum classes with to_string, from_string (O(1), with a perfect hash made at compile time) and printing
 */
 
 #ifndef DISABLE_INCLUDES
     #include <stdio.h>
     #include <stdint.h>
     #include <stdlib.h>
+    #include <string.h> // for memcpy
+    #include <time.h>   // for timespec_get, used by PRINT_FLUSH_TIMED
+    #ifdef _WIN32
+        #include <io.h>     // for _write
+        #include <intrin.h> // for _InterlockedExchange and _mm_pause
+    #else
+        #include <unistd.h> // for write
+        #include <sched.h>  // for sched_yield
+        #if defined(__x86_64__) || defined(__i386__)
+        #include <emmintrin.h> // for _mm_pause
+        #endif
+    #endif
 #endif
 
 typedef int8_t   s8;
@@ -83,20 +99,251 @@ typedef double   f64;
 // print("input broken: %");               // prints 'input broken: %' instead of having '(missing input)' because it was instructed with printing directly the input as a string, since no other inputs were given.
 //
 
-#define _buffer_append(fmt, ...) __buffer_index += snprintf(__print_buff + __buffer_index, __BUFF_SIZE - __buffer_index, fmt, __VA_ARGS__)
+//
+// Every print is accumulated in a buffer, which is then written out depending on the flush policy:
+// - PRINT_FLUSH_ALWAYS  after every print/printsl (default, so prints are never mixed up with printf),
+//                       except a printsl that leaves its line unfinished, which waits for the end of the line
+// - PRINT_FLUSH_LINE    after every print that ends with a newline (print, PRINT), printsl waits
+// - PRINT_FLUSH_FULL    only when the buffer is full (or when you call flush_to_stdout)
+// - PRINT_FLUSH_TIMED   when the buffer is full, or after a print if at least interval_ms passed since the last write
+// With PRINT_FLUSH_FULL thousands of lines become a single write, which is way faster on chatty code.
+// Whatever is left in the buffer gets written when the thread (or program) exits, or an ASSERT fails.
+//
+// By default we write to stdout with fwrite, with print_set_output_fd we skip the FILE* layer (and its own buffer)
+// and call write(2) directly on a file descriptor (1 for stdout, 2 for stderr, or any file you opened).
+//
+// Each thread has its own buffer, so you can print from many threads at the same time without locks
+// while formatting, we only lock when a buffer is written out. Only whole lines are written
+// (unless a single line is bigger than the buffer, or you call flush_to_stdout in the middle of a line),
+// so lines from different threads never get mixed.
+// Since each thread writes when its own buffer is full, lines can come out of order, if you need the
+// real order turn on print_set_sequence_stamps: every line starts with '#<number> ' (taken when the line
+// started printing), so you can sort the output later.
+//
+enum PrintFlushPolicy {
+    PRINT_FLUSH_ALWAYS,
+    PRINT_FLUSH_LINE,
+    PRINT_FLUSH_FULL,
+    PRINT_FLUSH_TIMED,
+};
+
+#define _buffer_append(fmt, ...) _print_buffer_append_formatted(fmt, __VA_ARGS__)
+
+const int __BUFF_SIZE = 0x1000; // default size
+
+// shared by every thread
+PrintFlushPolicy __print_flush_policy = PRINT_FLUSH_ALWAYS;
+s64 __print_flush_interval_ms = 0;
+int __print_output_fd = -1; // -1 means stdout with fwrite
+bool __print_sequence_stamps = false;
+volatile s64 __print_sequence = 0;
+volatile long __print_sink_locked = 0;
+
+struct _PrintBuffer {
+    char default_buff[__BUFF_SIZE];
+    char* buff = default_buff;
+    int size = __BUFF_SIZE;
+    int index = 0;
+    int no_newline_until = 0; // the buffer has no newline before this index, so we don't search it again
+    s64 last_flush_ms = 0;
+    bool at_line_start = true;
+    void (*sink)(const char* data, int size) = NULL; // if set, this thread writes here instead of stdout (see logger.h)
+    ~_PrintBuffer();
+};
+thread_local _PrintBuffer __print;
+
+inline s64 _print_time_ms() {
+    timespec t;
+    timespec_get(&t, TIME_UTC);
+    return (s64)t.tv_sec * 1000 + t.tv_nsec / 1000000;
+}
+
+#ifdef _WIN32
+extern "C" __declspec(dllimport) int __stdcall SwitchToThread(); // from windows.h, which is too big to include here
+#endif
+
+// NOTE: threads.h has proper atomics, but it needs this file, so we use the intrinsics directly.
+// The lock is held across the write syscall, so after spinning for a bit the waiting threads give up their time slice.
+inline void _print_sink_lock() {
+    s32 spins = 0;
+    while(true) {
+        #ifdef _MSC_VER
+        if(_InterlockedExchange(&__print_sink_locked, 1) == 0) return;
+        while(__print_sink_locked != 0) { // wait with plain reads, so we don't keep stealing the cache line from the owner
+        #else
+        if(__atomic_exchange_n(&__print_sink_locked, 1, __ATOMIC_ACQUIRE) == 0) return;
+        while(__atomic_load_n(&__print_sink_locked, __ATOMIC_RELAXED) != 0) { // wait with plain reads, so we don't keep stealing the cache line from the owner
+        #endif
+            if(spins < 64) {
+                #if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+                _mm_pause();
+                #endif
+                spins++;
+            } else {
+                #ifdef _WIN32
+                SwitchToThread();
+                #else
+                sched_yield();
+                #endif
+            }
+        }
+    }
+}
+inline void _print_sink_unlock() {
+    #ifdef _MSC_VER
+    _InterlockedExchange(&__print_sink_locked, 0);
+    #else
+    __atomic_store_n(&__print_sink_locked, 0, __ATOMIC_RELEASE);
+    #endif
+}
+
+inline s64 _print_next_sequence() {
+    #ifdef _MSC_VER
+    return _InterlockedExchangeAdd64(&__print_sequence, 1);
+    #else
+    return __atomic_fetch_add(&__print_sequence, 1, __ATOMIC_RELAXED);
+    #endif
+}
 
-int __buffer_index = 0;
-const int __BUFF_SIZE = 0xFFF;
-char __print_buff[__BUFF_SIZE] = "";
+inline void _print_write_out(const char* data, int size) {
+    _print_sink_lock();
+    if(__print.sink != NULL) {
+        __print.sink(data, size);
+    } else if(__print_output_fd < 0) {
+        fwrite(data, 1, size, stdout);
+    } else {
+        while(size > 0) {
+            #ifdef _WIN32
+            int written = _write(__print_output_fd, data, size);
+            #else
+            int written = (int)write(__print_output_fd, data, size);
+            #endif
+            if(written <= 0) break; // nowhere to report the error, printing it would just fail again
+            data += written;
+            size -= written;
+        }
+    }
+    _print_sink_unlock();
+}
+
+// writes everything printed by this thread
 inline void flush_to_stdout() {
-    fwrite(__print_buff, 1, __buffer_index, stdout);
-    __buffer_index = 0;
+    if(__print.index > 0) _print_write_out(__print.buff, __print.index);
+    __print.index = 0;
+    __print.no_newline_until = 0;
+    if(__print_flush_policy == PRINT_FLUSH_TIMED) __print.last_flush_ms = _print_time_ms();
+}
+
+_PrintBuffer::~_PrintBuffer() {
+    flush_to_stdout();
+    if(buff != default_buff) free(buff);
+}
+
+// writes out only the lines already completed so they're never split in half, the unfinished one stays in the buffer.
+// Returns false if there's no completed line
+inline bool _print_write_lines() {
+    int last_newline = __print.index - 1;
+    while(last_newline >= __print.no_newline_until && __print.buff[last_newline] != '\n') last_newline--;
+    if(last_newline < __print.no_newline_until) {
+        __print.no_newline_until = __print.index;
+        return false;
+    }
+    
+    int completed = last_newline + 1;
+    _print_write_out(__print.buff, completed);
+    memmove(__print.buff, __print.buff + completed, __print.index - completed);
+    __print.index -= completed;
+    __print.no_newline_until = __print.index;
+    return true;
+}
+
+// the buffer is full
+inline void _print_make_space() {
+    if(!_print_write_lines()) flush_to_stdout(); // a single line bigger than the whole buffer, we can't do better than this
+}
+
+// called at the start of every print/printsl
+inline void _print_begin() {
+    if(!__print_sequence_stamps || !__print.at_line_start) return;
+    __print.at_line_start = false;
+    if(__print.size - __print.index < 24) _print_make_space();
+    __print.index += snprintf(__print.buff + __print.index, __print.size - __print.index, "#%lld ", (long long)_print_next_sequence());
+}
+
+// called at the end of every print/printsl
+inline void _print_maybe_flush(bool ends_with_newline) {
+    if(ends_with_newline) __print.at_line_start = true;
+    switch(__print_flush_policy) {
+        case PRINT_FLUSH_ALWAYS: _print_write_lines(); break;
+        case PRINT_FLUSH_LINE:   if(ends_with_newline) _print_write_lines(); break;
+        case PRINT_FLUSH_FULL:   break; // done when writing to the buffer
+        case PRINT_FLUSH_TIMED: {
+            s64 now = _print_time_ms();
+            if(now - __print.last_flush_ms < __print_flush_interval_ms) break;
+            _print_write_lines();
+            __print.last_flush_ms = now;
+        } break;
+    }
+}
+
+// interval_ms is only used by PRINT_FLUSH_TIMED. Applies to every thread.
+inline void print_set_flush_policy(PrintFlushPolicy policy, s64 interval_ms = 0) {
+    flush_to_stdout();
+    __print_flush_policy = policy;
+    __print_flush_interval_ms = interval_ms;
+    __print.last_flush_ms = _print_time_ms();
+}
+
+// how many bytes the calling thread can accumulate before a write (only matters with PRINT_FLUSH_FULL and PRINT_FLUSH_TIMED)
+inline void print_set_buffer_size(int size) {
+    if(size < 64) size = 64; // we need a bit of space to format numbers
+    flush_to_stdout();
+    char* new_buff = __print.buff == __print.default_buff ? (char*)malloc(size) : (char*)realloc(__print.buff, size);
+    if(new_buff == NULL) return; // keep the old one, printing still works
+    __print.buff = new_buff;
+    __print.size = size;
+}
+
+// fd < 0 goes back to stdout with fwrite. Applies to every thread.
+inline void print_set_output_fd(int fd) {
+    flush_to_stdout();
+    if(fd >= 0) fflush(stdout); // whatever is still in the stdout FILE* must come before what we write directly
+    __print_output_fd = fd;
+}
+
+// Applies to every thread, see the explanation above.
+inline void print_set_sequence_stamps(bool enabled) { __print_sequence_stamps = enabled; }
+
+// overflow safe writes into the buffer, they write out completed lines when there's not enough space
+inline void _print_buffer_append(const char* data, int size) {
+    if(size > __print.size - __print.index) {
+        _print_make_space();
+        if(size > __print.size - __print.index) flush_to_stdout();
+        if(size > __print.size) { _print_write_out(data, size); return; } // would never fit, no need to copy it
+    }
+    memcpy(__print.buff + __print.index, data, size);
+    __print.index += size;
+}
+
+template <typename... Types>
+inline void _print_buffer_append_formatted(const char* fmt, Types... inputs) {
+    int space_left = __print.size - __print.index;
+    int written = snprintf(__print.buff + __print.index, space_left, fmt, inputs...);
+    if(written < 0) return;
+    if(written >= space_left) {
+        // it didn't fit, try again with more space
+        _print_make_space();
+        if(written >= __print.size - __print.index) flush_to_stdout();
+        written = snprintf(__print.buff + __print.index, __print.size - __print.index, fmt, inputs...);
+        if(written >= __print.size - __print.index) written = __print.size - __print.index - 1; // still too big, print what we can
+    }
+    __print.index += written;
 }
 
 // print standard specializations
 // API(cogno): maybe a name like custom_format is better? I don't know
-inline void printsl_custom(const char* s) { int index = 0; while(s[index]) __print_buff[__buffer_index++] = s[index++]; }
-inline void printsl_custom(char c)        { __print_buff[__buffer_index++] = c; }
+inline void printsl_custom(const char* s) { _print_buffer_append(s, (int)strlen(s)); }
+inline void printsl_custom(char c)        { if(__print.index >= __print.size) _print_make_space(); __print.buff[__print.index++] = c; }
 inline void printsl_custom(s8  d)         { _buffer_append("%d",   d); }
 inline void printsl_custom(s16 d)         { _buffer_append("%d",   d); }
 inline void printsl_custom(s32 d)         { _buffer_append("%ld",  d); }
@@ -172,15 +419,17 @@ void _accumulate_into_buffer(const char* s, T t1, Types... others) {
 //
 template <typename T>
 void printsl(T t) {
+    _print_begin();
     printsl_custom(t);
-    flush_to_stdout();
+    _print_maybe_flush(false);
 }
 
 template <typename T>
 void print(T t) {
+    _print_begin();
     printsl_custom(t);
     printsl_custom('\n');
-    flush_to_stdout();
+    _print_maybe_flush(true);
 }
 
 //
@@ -188,16 +437,95 @@ void print(T t) {
 //
 template <typename T, typename... Types>
 void printsl(const char* s, T t1, Types... others) {
+    _print_begin();
     _accumulate_into_buffer(s, t1, others...);
-    flush_to_stdout();
+    _print_maybe_flush(false);
 }
 
 // print formatting
 template <typename T, typename... Types>
 void print(const char* s, T t1, Types... others) {
+    _print_begin();
     _accumulate_into_buffer(s, t1, others...);
     printsl_custom('\n');
-    flush_to_stdout();
+    _print_maybe_flush(true);
+}
+
+//
+// PRINT and PRINTSL: same as print and printsl (same rules for '%' and '\\%'), but the format string
+// is parsed while compiling, so at runtime we only copy the text between the '%' and print each input,
+// without looking at the format string character by character.
+// The format must be a string literal, and giving more or less inputs than '%' is a compile error.
+//
+// example usage:
+// PRINT("values a=%, b=%", a, b);         // prints 'values a=15, b=12.50000'
+// PRINT("this is a percentage: %\\%", a); // prints 'this is a percentage: 15%'
+// PRINT("input forgotten: %, %", a);      // does NOT compile
+//
+#define PRINTSL(fmt, ...) _print_format(_FORMAT_STRING(fmt), false,##__VA_ARGS__)
+#define PRINT(fmt, ...) _print_format(_FORMAT_STRING(fmt), true,##__VA_ARGS__)
+
+// makes a unique type which holds the string literal, so templates can read it at compile time
+#define _FORMAT_STRING(fmt) []() { struct _Format { static constexpr const char* get() { return fmt; } static constexpr int size() { return sizeof(fmt); } }; return _Format(); }()
+
+// The format string split at compile time: every piece of text (with escapes already removed) is
+// concatenated in 'text', and piece_end[i] tells where the text before the i-th input ends.
+template <int N>
+struct _FormatSpec {
+    char text[N] = {};
+    int piece_end[N] = {};
+    int input_count = 0;
+};
+
+template <typename Format>
+constexpr _FormatSpec<Format::size()> _parse_format() {
+    _FormatSpec<Format::size()> spec = {};
+    const char* s = Format::get();
+    int text_size = 0;
+    for(int i = 0; s[i] != 0; i++) {
+        char c = s[i];
+        if(c == '\\') {
+            if(s[i + 1] == '%') { spec.text[text_size++] = '%'; i++; }
+        } else if(c == '%') {
+            spec.piece_end[spec.input_count++] = text_size;
+        } else {
+            spec.text[text_size++] = c;
+        }
+    }
+    spec.piece_end[spec.input_count] = text_size;
+    return spec;
+}
+
+template <typename Format>
+struct _FormatSpecOf { static constexpr _FormatSpec<Format::size()> value = _parse_format<Format>(); };
+
+template <typename Format, int Index>
+inline void _accumulate_format_piece() {
+    constexpr int start = Index == 0 ? 0 : _FormatSpecOf<Format>::value.piece_end[Index - 1];
+    constexpr int size = _FormatSpecOf<Format>::value.piece_end[Index] - start;
+    if(size == 0) return;
+    _print_buffer_append(_FormatSpecOf<Format>::value.text + start, size);
+}
+
+template <typename Format, int Index>
+inline void _accumulate_format() {
+    _accumulate_format_piece<Format, Index>(); // text after the last input
+}
+
+template <typename Format, int Index, typename T, typename... Types>
+inline void _accumulate_format(T t1, Types... others) {
+    _accumulate_format_piece<Format, Index>();
+    printsl_custom(t1);
+    _accumulate_format<Format, Index + 1>(others...);
+}
+
+template <typename Format, typename... Types>
+inline void _print_format(Format, bool newline, Types... inputs) {
+    static_assert(_FormatSpecOf<Format>::value.input_count == sizeof...(Types), "the number of '%' in the format string is different from the number of inputs given");
+    _print_begin();
+    _accumulate_format<Format, 0>(inputs...);
+    if(newline) printsl_custom('\n');
+    _print_maybe_flush(newline);
 }
 
 
@@ -237,6 +565,7 @@ inline bool assert_func(bool expr, const char* expression_as_string, const char*
         print("    File: %", filename);
         print("    Line: %", line_count);
         print("    Function: %", function_name);
+        flush_to_stdout(); // abort doesn't call atexit, make sure the message (and everything before it) is written
         DEBUG_BREAK;
         abort(); // so the stack trace works (exit(-1) or exit(0) don't)
     }
@@ -253,6 +582,7 @@ inline bool assert_func(bool expr, const char* expression_as_string, const char*
         print("    File: %", filename);
         print("    Line: %", line_count);
         print("    Function: %", function_name);
+        flush_to_stdout(); // abort doesn't call atexit, make sure the message (and everything before it) is written
         DEBUG_BREAK;
         abort(); // so the stack trace works (exit(-1) or exit(0) don't)
     }
@@ -417,20 +747,261 @@ struct {
 #define STRINGIFY_(n, ...) TO_STR_N(n, __VA_ARGS__)
 #define STRINGIFY(...) MSVC_BUG(STRINGIFY_, (COUNTER(__VA_ARGS__), __VA_ARGS__))
 
+// calls a macro on each argument, FOR_EACH(M, a, b, c) becomes M(a) M(b) M(c) (up to 64 arguments, same wall as above)
+#define FOR_EACH_1(M, _1) M(_1)
+#define FOR_EACH_2(M, _1, _2) M(_1) M(_2)
+#define FOR_EACH_3(M, _1, _2, _3) M(_1) M(_2) M(_3)
+#define FOR_EACH_4(M, _1, _2, _3, _4) M(_1) M(_2) M(_3) M(_4)
+#define FOR_EACH_5(M, _1, _2, _3, _4, _5) M(_1) M(_2) M(_3) M(_4) M(_5)
+#define FOR_EACH_6(M, _1, _2, _3, _4, _5, _6) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6)
+#define FOR_EACH_7(M, _1, _2, _3, _4, _5, _6, _7) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7)
+#define FOR_EACH_8(M, _1, _2, _3, _4, _5, _6, _7, _8) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8)
+#define FOR_EACH_9(M, _1, _2, _3, _4, _5, _6, _7, _8, _9) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9)
+#define FOR_EACH_10(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10)
+#define FOR_EACH_11(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11)
+#define FOR_EACH_12(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12)
+#define FOR_EACH_13(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13)
+#define FOR_EACH_14(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14)
+#define FOR_EACH_15(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15)
+#define FOR_EACH_16(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16)
+#define FOR_EACH_17(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17)
+#define FOR_EACH_18(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18)
+#define FOR_EACH_19(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19)
+#define FOR_EACH_20(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20)
+#define FOR_EACH_21(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21)
+#define FOR_EACH_22(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22)
+#define FOR_EACH_23(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23)
+#define FOR_EACH_24(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24)
+#define FOR_EACH_25(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25)
+#define FOR_EACH_26(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26)
+#define FOR_EACH_27(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27)
+#define FOR_EACH_28(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28)
+#define FOR_EACH_29(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28) M(_29)
+#define FOR_EACH_30(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28) M(_29) M(_30)
+#define FOR_EACH_31(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28) M(_29) M(_30) M(_31)
+#define FOR_EACH_32(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28) M(_29) M(_30) M(_31) M(_32)
+#define FOR_EACH_33(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28) M(_29) M(_30) M(_31) M(_32) M(_33)
+#define FOR_EACH_34(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28) M(_29) M(_30) M(_31) M(_32) M(_33) M(_34)
+#define FOR_EACH_35(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28) M(_29) M(_30) M(_31) M(_32) M(_33) M(_34) M(_35)
+#define FOR_EACH_36(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35, _36) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28) M(_29) M(_30) M(_31) M(_32) M(_33) M(_34) M(_35) M(_36)
+#define FOR_EACH_37(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35, _36, _37) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28) M(_29) M(_30) M(_31) M(_32) M(_33) M(_34) M(_35) M(_36) M(_37)
+#define FOR_EACH_38(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35, _36, _37, _38) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28) M(_29) M(_30) M(_31) M(_32) M(_33) M(_34) M(_35) M(_36) M(_37) M(_38)
+#define FOR_EACH_39(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35, _36, _37, _38, _39) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28) M(_29) M(_30) M(_31) M(_32) M(_33) M(_34) M(_35) M(_36) M(_37) M(_38) M(_39)
+#define FOR_EACH_40(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35, _36, _37, _38, _39, _40) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28) M(_29) M(_30) M(_31) M(_32) M(_33) M(_34) M(_35) M(_36) M(_37) M(_38) M(_39) M(_40)
+#define FOR_EACH_41(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35, _36, _37, _38, _39, _40, _41) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28) M(_29) M(_30) M(_31) M(_32) M(_33) M(_34) M(_35) M(_36) M(_37) M(_38) M(_39) M(_40) M(_41)
+#define FOR_EACH_42(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35, _36, _37, _38, _39, _40, _41, _42) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28) M(_29) M(_30) M(_31) M(_32) M(_33) M(_34) M(_35) M(_36) M(_37) M(_38) M(_39) M(_40) M(_41) M(_42)
+#define FOR_EACH_43(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35, _36, _37, _38, _39, _40, _41, _42, _43) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28) M(_29) M(_30) M(_31) M(_32) M(_33) M(_34) M(_35) M(_36) M(_37) M(_38) M(_39) M(_40) M(_41) M(_42) M(_43)
+#define FOR_EACH_44(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35, _36, _37, _38, _39, _40, _41, _42, _43, _44) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28) M(_29) M(_30) M(_31) M(_32) M(_33) M(_34) M(_35) M(_36) M(_37) M(_38) M(_39) M(_40) M(_41) M(_42) M(_43) M(_44)
+#define FOR_EACH_45(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35, _36, _37, _38, _39, _40, _41, _42, _43, _44, _45) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28) M(_29) M(_30) M(_31) M(_32) M(_33) M(_34) M(_35) M(_36) M(_37) M(_38) M(_39) M(_40) M(_41) M(_42) M(_43) M(_44) M(_45)
+#define FOR_EACH_46(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35, _36, _37, _38, _39, _40, _41, _42, _43, _44, _45, _46) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28) M(_29) M(_30) M(_31) M(_32) M(_33) M(_34) M(_35) M(_36) M(_37) M(_38) M(_39) M(_40) M(_41) M(_42) M(_43) M(_44) M(_45) M(_46)
+#define FOR_EACH_47(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35, _36, _37, _38, _39, _40, _41, _42, _43, _44, _45, _46, _47) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28) M(_29) M(_30) M(_31) M(_32) M(_33) M(_34) M(_35) M(_36) M(_37) M(_38) M(_39) M(_40) M(_41) M(_42) M(_43) M(_44) M(_45) M(_46) M(_47)
+#define FOR_EACH_48(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35, _36, _37, _38, _39, _40, _41, _42, _43, _44, _45, _46, _47, _48) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28) M(_29) M(_30) M(_31) M(_32) M(_33) M(_34) M(_35) M(_36) M(_37) M(_38) M(_39) M(_40) M(_41) M(_42) M(_43) M(_44) M(_45) M(_46) M(_47) M(_48)
+#define FOR_EACH_49(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35, _36, _37, _38, _39, _40, _41, _42, _43, _44, _45, _46, _47, _48, _49) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28) M(_29) M(_30) M(_31) M(_32) M(_33) M(_34) M(_35) M(_36) M(_37) M(_38) M(_39) M(_40) M(_41) M(_42) M(_43) M(_44) M(_45) M(_46) M(_47) M(_48) M(_49)
+#define FOR_EACH_50(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35, _36, _37, _38, _39, _40, _41, _42, _43, _44, _45, _46, _47, _48, _49, _50) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28) M(_29) M(_30) M(_31) M(_32) M(_33) M(_34) M(_35) M(_36) M(_37) M(_38) M(_39) M(_40) M(_41) M(_42) M(_43) M(_44) M(_45) M(_46) M(_47) M(_48) M(_49) M(_50)
+#define FOR_EACH_51(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35, _36, _37, _38, _39, _40, _41, _42, _43, _44, _45, _46, _47, _48, _49, _50, _51) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28) M(_29) M(_30) M(_31) M(_32) M(_33) M(_34) M(_35) M(_36) M(_37) M(_38) M(_39) M(_40) M(_41) M(_42) M(_43) M(_44) M(_45) M(_46) M(_47) M(_48) M(_49) M(_50) M(_51)
+#define FOR_EACH_52(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35, _36, _37, _38, _39, _40, _41, _42, _43, _44, _45, _46, _47, _48, _49, _50, _51, _52) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28) M(_29) M(_30) M(_31) M(_32) M(_33) M(_34) M(_35) M(_36) M(_37) M(_38) M(_39) M(_40) M(_41) M(_42) M(_43) M(_44) M(_45) M(_46) M(_47) M(_48) M(_49) M(_50) M(_51) M(_52)
+#define FOR_EACH_53(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35, _36, _37, _38, _39, _40, _41, _42, _43, _44, _45, _46, _47, _48, _49, _50, _51, _52, _53) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28) M(_29) M(_30) M(_31) M(_32) M(_33) M(_34) M(_35) M(_36) M(_37) M(_38) M(_39) M(_40) M(_41) M(_42) M(_43) M(_44) M(_45) M(_46) M(_47) M(_48) M(_49) M(_50) M(_51) M(_52) M(_53)
+#define FOR_EACH_54(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35, _36, _37, _38, _39, _40, _41, _42, _43, _44, _45, _46, _47, _48, _49, _50, _51, _52, _53, _54) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28) M(_29) M(_30) M(_31) M(_32) M(_33) M(_34) M(_35) M(_36) M(_37) M(_38) M(_39) M(_40) M(_41) M(_42) M(_43) M(_44) M(_45) M(_46) M(_47) M(_48) M(_49) M(_50) M(_51) M(_52) M(_53) M(_54)
+#define FOR_EACH_55(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35, _36, _37, _38, _39, _40, _41, _42, _43, _44, _45, _46, _47, _48, _49, _50, _51, _52, _53, _54, _55) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28) M(_29) M(_30) M(_31) M(_32) M(_33) M(_34) M(_35) M(_36) M(_37) M(_38) M(_39) M(_40) M(_41) M(_42) M(_43) M(_44) M(_45) M(_46) M(_47) M(_48) M(_49) M(_50) M(_51) M(_52) M(_53) M(_54) M(_55)
+#define FOR_EACH_56(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35, _36, _37, _38, _39, _40, _41, _42, _43, _44, _45, _46, _47, _48, _49, _50, _51, _52, _53, _54, _55, _56) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28) M(_29) M(_30) M(_31) M(_32) M(_33) M(_34) M(_35) M(_36) M(_37) M(_38) M(_39) M(_40) M(_41) M(_42) M(_43) M(_44) M(_45) M(_46) M(_47) M(_48) M(_49) M(_50) M(_51) M(_52) M(_53) M(_54) M(_55) M(_56)
+#define FOR_EACH_57(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35, _36, _37, _38, _39, _40, _41, _42, _43, _44, _45, _46, _47, _48, _49, _50, _51, _52, _53, _54, _55, _56, _57) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28) M(_29) M(_30) M(_31) M(_32) M(_33) M(_34) M(_35) M(_36) M(_37) M(_38) M(_39) M(_40) M(_41) M(_42) M(_43) M(_44) M(_45) M(_46) M(_47) M(_48) M(_49) M(_50) M(_51) M(_52) M(_53) M(_54) M(_55) M(_56) M(_57)
+#define FOR_EACH_58(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35, _36, _37, _38, _39, _40, _41, _42, _43, _44, _45, _46, _47, _48, _49, _50, _51, _52, _53, _54, _55, _56, _57, _58) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28) M(_29) M(_30) M(_31) M(_32) M(_33) M(_34) M(_35) M(_36) M(_37) M(_38) M(_39) M(_40) M(_41) M(_42) M(_43) M(_44) M(_45) M(_46) M(_47) M(_48) M(_49) M(_50) M(_51) M(_52) M(_53) M(_54) M(_55) M(_56) M(_57) M(_58)
+#define FOR_EACH_59(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35, _36, _37, _38, _39, _40, _41, _42, _43, _44, _45, _46, _47, _48, _49, _50, _51, _52, _53, _54, _55, _56, _57, _58, _59) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28) M(_29) M(_30) M(_31) M(_32) M(_33) M(_34) M(_35) M(_36) M(_37) M(_38) M(_39) M(_40) M(_41) M(_42) M(_43) M(_44) M(_45) M(_46) M(_47) M(_48) M(_49) M(_50) M(_51) M(_52) M(_53) M(_54) M(_55) M(_56) M(_57) M(_58) M(_59)
+#define FOR_EACH_60(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35, _36, _37, _38, _39, _40, _41, _42, _43, _44, _45, _46, _47, _48, _49, _50, _51, _52, _53, _54, _55, _56, _57, _58, _59, _60) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28) M(_29) M(_30) M(_31) M(_32) M(_33) M(_34) M(_35) M(_36) M(_37) M(_38) M(_39) M(_40) M(_41) M(_42) M(_43) M(_44) M(_45) M(_46) M(_47) M(_48) M(_49) M(_50) M(_51) M(_52) M(_53) M(_54) M(_55) M(_56) M(_57) M(_58) M(_59) M(_60)
+#define FOR_EACH_61(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35, _36, _37, _38, _39, _40, _41, _42, _43, _44, _45, _46, _47, _48, _49, _50, _51, _52, _53, _54, _55, _56, _57, _58, _59, _60, _61) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28) M(_29) M(_30) M(_31) M(_32) M(_33) M(_34) M(_35) M(_36) M(_37) M(_38) M(_39) M(_40) M(_41) M(_42) M(_43) M(_44) M(_45) M(_46) M(_47) M(_48) M(_49) M(_50) M(_51) M(_52) M(_53) M(_54) M(_55) M(_56) M(_57) M(_58) M(_59) M(_60) M(_61)
+#define FOR_EACH_62(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35, _36, _37, _38, _39, _40, _41, _42, _43, _44, _45, _46, _47, _48, _49, _50, _51, _52, _53, _54, _55, _56, _57, _58, _59, _60, _61, _62) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28) M(_29) M(_30) M(_31) M(_32) M(_33) M(_34) M(_35) M(_36) M(_37) M(_38) M(_39) M(_40) M(_41) M(_42) M(_43) M(_44) M(_45) M(_46) M(_47) M(_48) M(_49) M(_50) M(_51) M(_52) M(_53) M(_54) M(_55) M(_56) M(_57) M(_58) M(_59) M(_60) M(_61) M(_62)
+#define FOR_EACH_63(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35, _36, _37, _38, _39, _40, _41, _42, _43, _44, _45, _46, _47, _48, _49, _50, _51, _52, _53, _54, _55, _56, _57, _58, _59, _60, _61, _62, _63) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28) M(_29) M(_30) M(_31) M(_32) M(_33) M(_34) M(_35) M(_36) M(_37) M(_38) M(_39) M(_40) M(_41) M(_42) M(_43) M(_44) M(_45) M(_46) M(_47) M(_48) M(_49) M(_50) M(_51) M(_52) M(_53) M(_54) M(_55) M(_56) M(_57) M(_58) M(_59) M(_60) M(_61) M(_62) M(_63)
+#define FOR_EACH_64(M, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35, _36, _37, _38, _39, _40, _41, _42, _43, _44, _45, _46, _47, _48, _49, _50, _51, _52, _53, _54, _55, _56, _57, _58, _59, _60, _61, _62, _63, _64) M(_1) M(_2) M(_3) M(_4) M(_5) M(_6) M(_7) M(_8) M(_9) M(_10) M(_11) M(_12) M(_13) M(_14) M(_15) M(_16) M(_17) M(_18) M(_19) M(_20) M(_21) M(_22) M(_23) M(_24) M(_25) M(_26) M(_27) M(_28) M(_29) M(_30) M(_31) M(_32) M(_33) M(_34) M(_35) M(_36) M(_37) M(_38) M(_39) M(_40) M(_41) M(_42) M(_43) M(_44) M(_45) M(_46) M(_47) M(_48) M(_49) M(_50) M(_51) M(_52) M(_53) M(_54) M(_55) M(_56) M(_57) M(_58) M(_59) M(_60) M(_61) M(_62) M(_63) M(_64)
+
+#define FOR_EACH_N(n, M, ...) MSVC_BUG(STR_CONCAT(FOR_EACH_, n), (M, __VA_ARGS__))
+#define FOR_EACH_(n, M, ...) FOR_EACH_N(n, M, __VA_ARGS__)
+#define FOR_EACH(M, ...) MSVC_BUG(FOR_EACH_, (COUNTER(__VA_ARGS__), M, __VA_ARGS__))
+
+// Perfect hash of the names of an ENUM, built at compile time, so from_string is O(1) and never allocates.
+// Each name goes in a bucket (hash with seed 0), then each bucket gets its own seed so its names land
+// in free slots without colliding (hash and displace), a lookup is always 2 hashes and 1 compare.
+constexpr u32 _enum_hash(const char* s, s32 size, u32 seed) {
+    u32 hash = 2166136261u ^ (seed * 0x9E3779B9u); // fnv-1a
+    for(s32 i = 0; i < size; i++) {
+        hash ^= (u8)s[i];
+        hash *= 16777619u;
+    }
+    hash ^= hash >> 15; // fnv's low bits are weak, and we only use those
+    hash *= 0x2C1B3C6Du;
+    hash ^= hash >> 12;
+    return hash;
+}
+
+constexpr s32 _enum_strlen(const char* s) { s32 size = 0; while(s[size] != 0) size++; return size; }
+
+constexpr s32 _enum_hash_slots(s32 names) { s32 slots = 1; while(slots < names * 2) slots *= 2; return slots; }
+
+template<int N>
+struct _EnumHashTable {
+    static constexpr s32 SLOTS = _enum_hash_slots(N);
+    u32 seeds[SLOTS]; // bucket -> seed which places every name in the bucket without collisions
+    s32 slots[SLOTS]; // slot -> index of the name, -1 if empty
+    s32 lengths[N];
+
+    constexpr _EnumHashTable(const char* const (&names)[N]) : seeds(), slots(), lengths() {
+        s32 bucket_of[N] = {};
+        s32 bucket_size[SLOTS] = {};
+        s32 biggest = 0;
+        for(s32 i = 0; i < N; i++) {
+            lengths[i] = _enum_strlen(names[i]);
+            bucket_of[i] = _enum_hash(names[i], lengths[i], 0) & (SLOTS - 1);
+            bucket_size[bucket_of[i]]++;
+            if(bucket_size[bucket_of[i]] > biggest) biggest = bucket_size[bucket_of[i]];
+        }
+        for(s32 i = 0; i < SLOTS; i++) slots[i] = -1;
+
+        // biggest buckets first, while there are many free slots, since they're the hardest to place
+        for(s32 size = biggest; size > 0; size--) {
+            for(s32 bucket = 0; bucket < SLOTS; bucket++) {
+                if(bucket_size[bucket] != size) continue;
+                for(u32 seed = 1; ; seed++) {
+                    s32 placed[N] = {};
+                    s32 placed_count = 0;
+                    for(s32 i = 0; i < N; i++) {
+                        if(bucket_of[i] != bucket) continue;
+                        s32 slot = _enum_hash(names[i], lengths[i], seed) & (SLOTS - 1);
+                        bool taken = slots[slot] != -1;
+                        for(s32 j = 0; j < placed_count; j++) taken = taken || placed[j] == slot;
+                        if(taken) break;
+                        placed[placed_count++] = slot;
+                    }
+                    if(placed_count != size) continue; // some names collided, try the next seed
+                    placed_count = 0;
+                    for(s32 i = 0; i < N; i++) if(bucket_of[i] == bucket) slots[placed[placed_count++]] = i;
+                    seeds[bucket] = seed;
+                    break;
+                }
+            }
+        }
+    }
+};
+
+template<int N>
+bool _enum_hash_find(const _EnumHashTable<N>* table, const char* const* names, const char* s, s32 size, s32* out_index) {
+    const s32 mask = _EnumHashTable<N>::SLOTS - 1;
+    u32 seed = table->seeds[_enum_hash(s, size, 0) & mask];
+    s32 index = table->slots[_enum_hash(s, size, seed) & mask];
+    if(index < 0 || table->lengths[index] != size || memcmp(names[index], s, size) != 0) return false; // not one of the names
+    *out_index = index;
+    return true;
+}
+
+// enum class with to_string, from_string (O(1), see _EnumHashTable) and printing. Values must be consecutive from 0.
+// Example:
+// ENUM(Color, RED, GREEN, BLUE);
+// Color c;
+// if(from_string(text.ptr, text.size, &c)) print(c); // with str.h you can also do from_string(text, &c)
 #define ENUM(EnumName, ...) \
 enum class EnumName { __VA_ARGS__ }; \
 const int EnumName##Size = NUM_ARGS(__VA_ARGS__); \
-const char* EnumName##Strings[] = { STRINGIFY(__VA_ARGS__) }; \
+constexpr const char* EnumName##Strings[] = { STRINGIFY(__VA_ARGS__) }; \
+constexpr _EnumHashTable<EnumName##Size> EnumName##Hash(EnumName##Strings); \
 const char* to_string(EnumName to_convert) { \
     int index = (s32)to_convert; \
     if(index >= EnumName##Size || index < 0) return "(out of range)"; \
     return EnumName##Strings[index]; \
 } \
+bool from_string(const char* ptr, s32 size, EnumName* out) { \
+    s32 index; \
+    if(!_enum_hash_find(&EnumName##Hash, EnumName##Strings, ptr, size, &index)) return false; \
+    *out = (EnumName)index; \
+    return true; \
+} \
 void printsl_custom(EnumName to_print) { \
     printsl("%::%", #EnumName, to_string(to_print)); \
     if((s32)to_print >= EnumName##Size || (s32)to_print < 0) printsl("=>%", (s32)to_print); \
 }
 
+// Like ENUM but each value is a different bit, so they can be combined with | & ^ ~.
+// from_string parses names separated by '|' (like "READ|WRITE"), printing does the same.
+// No flags at all prints as "(none)", from_string takes it back (and the empty string too).
+// Example:
+// ENUM_FLAGS(Access, READ, WRITE, EXECUTE);
+// Access a = Access::READ | Access::WRITE;
+// if(has_flags(a, Access::WRITE)) ...
+#define ENUM_FLAGS(EnumName, ...) \
+struct _##EnumName##Flags { \
+    enum Bits { __VA_ARGS__ }; \
+    enum class Values : u32 { FOR_EACH(_ENUM_FLAG_VALUE, __VA_ARGS__) }; \
+}; \
+typedef _##EnumName##Flags::Values EnumName; \
+const int EnumName##Size = NUM_ARGS(__VA_ARGS__); \
+static_assert(EnumName##Size <= 32, "flags enums can have at most 32 values"); \
+constexpr const char* EnumName##Strings[] = { STRINGIFY(__VA_ARGS__) }; \
+constexpr _EnumHashTable<EnumName##Size> EnumName##Hash(EnumName##Strings); \
+constexpr EnumName operator |(EnumName a, EnumName b) { return (EnumName)((u32)a | (u32)b); } \
+constexpr EnumName operator &(EnumName a, EnumName b) { return (EnumName)((u32)a & (u32)b); } \
+constexpr EnumName operator ^(EnumName a, EnumName b) { return (EnumName)((u32)a ^ (u32)b); } \
+constexpr EnumName operator ~(EnumName a) { return (EnumName)(~(u32)a & (u32)((1ull << EnumName##Size) - 1)); } \
+inline EnumName& operator |=(EnumName& a, EnumName b) { return a = a | b; } \
+inline EnumName& operator &=(EnumName& a, EnumName b) { return a = a & b; } \
+inline EnumName& operator ^=(EnumName& a, EnumName b) { return a = a ^ b; } \
+constexpr bool has_flags(EnumName value, EnumName flags) { return ((u32)value & (u32)flags) == (u32)flags; } \
+/* the name of a single flag, for combinations of flags use print */ \
+const char* to_string(EnumName to_convert) { \
+    u32 bits = (u32)to_convert; \
+    if(bits == 0 || (bits & (bits - 1)) != 0) return "(not a single flag)"; \
+    s32 index = 0; \
+    while((bits >> index) != 1) index++; \
+    if(index >= EnumName##Size) return "(out of range)"; \
+    return EnumName##Strings[index]; \
+} \
+bool from_string(const char* ptr, s32 size, EnumName* out) { \
+    u32 bits; \
+    if(!_enum_flags_from_string(&EnumName##Hash, EnumName##Strings, ptr, size, &bits)) return false; \
+    *out = (EnumName)bits; \
+    return true; \
+} \
+void printsl_custom(EnumName to_print) { \
+    printsl("%::", #EnumName); \
+    _enum_flags_print(EnumName##Strings, EnumName##Size, (u32)to_print); \
+}
+
+#define _ENUM_FLAG_VALUE(name) name = 1u << Bits::name,
+
+template<int N>
+bool _enum_flags_from_string(const _EnumHashTable<N>* table, const char* const* names, const char* s, s32 size, u32* out_bits) {
+    u32 bits = 0;
+    // no flags, printed as "(none)"
+    s32 first = 0, last = size;
+    while(first < last && s[first] == ' ') first++;
+    while(last > first && s[last - 1] == ' ') last--;
+    if(first == last || (last - first == 6 && memcmp(s + first, "(none)", 6) == 0)) {
+        *out_bits = 0;
+        return true;
+    }
+    s32 start = 0;
+    for(s32 i = 0; i <= size; i++) {
+        if(i < size && s[i] != '|') continue;
+        s32 name_start = start, name_end = i;
+        while(name_start < name_end && s[name_start] == ' ') name_start++;
+        while(name_end > name_start && s[name_end - 1] == ' ') name_end--;
+        s32 index;
+        if(!_enum_hash_find(table, names, s + name_start, name_end - name_start, &index)) return false;
+        bits |= 1u << index;
+        start = i + 1;
+    }
+    *out_bits = bits;
+    return true;
+}
+
+void _enum_flags_print(const char* const* names, s32 names_count, u32 bits) {
+    if(bits == 0) { printsl("(none)"); return; }
+    bool first = true;
+    for(s32 i = 0; i < names_count; i++) {
+        if((bits & (1u << i)) == 0) continue;
+        printsl(first ? "%" : "|%", names[i]);
+        first = false;
+    }
+    u32 unknown = names_count >= 32 ? 0 : bits >> names_count << names_count;
+    if(unknown != 0) printsl(first ? "%" : "|%", unknown); // bits without a name
+}
+
 // 
 // macros for improved for cycle. 
 // Works with any structs with 'size' and 'ptr' values. 
@@ -3,29 +3,47 @@
 Configuration macros
 - NO_ASSERT
     used to disable all types of assert, improves performance but disables (some) safety checks
+- NO_LOG
+    used to remove every LOG_* call (see logger.h), GYO_LOG_MIN_LEVEL removes only the lower levels
 - DISABLE_INCLUDES
     used to disable all the internal includes for a custom implementation
 - PROFILING_V1
     if you want to deactivate profiling v1, simply add '#define PROFILING_V1 0`
+- PROFILING_V1_TRACE
+    add '#define PROFILING_V1_TRACE 1` to record a timeline of every TIME_BLOCK (see profile_save_chrome_trace)
+- PROFILING_V1_SAMPLING
+    add '#define PROFILING_V1_SAMPLING 1` to sample which TIME_BLOCKs are running (see profile_start_sampling)
 - SIMPLE_PROFILE
     if you want to deactivate simple profiling, simply add '#define SIMPLE_PROFILE 0`
 - SIMPLE_BENCHMARK
     if you want to deactivate benchmarking, simply add '#define SIMPLE_BENCHMARK 0`
+- HW_COUNTERS
+    add '#define HW_COUNTERS 1` to also report hardware counters (IPC, cache/branch misses) in profiling v1 and benchmarks (Linux only)
 */
 
 #include "first.h"
 #include "performance_counter.h" // so it can be used by other modules to check performance elements
+#include "threads.h"
 
 #include "math.h"
 #include "allocators.h"
 
 #include "array.h"
 #include "str.h"
+#include "str_tokenizer.h"
 #include "hashmap.h"
+#include "str_interner.h"
+#include "logger.h"
+#include "serialize.h"
+#include "int_codecs.h"
+#include "json.h"
+#include "thread_pool.h"
+#include "sort.h"
 
 #include "simple_profiling.h"
 #include "profiling_v1.h"
 #include "simple_benchmark.h"
+#include "benchmark.h"
 
 #if _WIN32
     #include "win64_basic.h"
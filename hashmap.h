@@ -1,4 +1,5 @@
 #pragma once
+#define GYO_HASHMAP
 /*
 In this file:
 - a simple to use hashmap, useful as a replacement to std::unordered_map
@@ -30,9 +31,10 @@ struct Finder {
 template<class T>
 u64 hash_default(T* str, int size){
     u64 hash = 5381;
+    u8* bytes = (u8*)str; // size is in bytes, not in T
 
     while (size-- > 0) {
-        u8 c = (u8)*str++;
+        u8 c = *bytes++;
         hash = ((hash << 5) + hash) + c; /* hash * 33 + c */
     }
 
@@ -120,6 +122,7 @@ void map_insert(HashMap<T, U>* map, T key, U value) {
         current_finder->next_finder_index = array_append(&map->solver, {}); // start an empty collision chain for successive insertions
     } else {
         // complex case, either we have the key and we need to replace the value, or we have to use solver to set a new key
+        int current_solver_index = MAP_INVALID_INDEX; // where current_finder is in the solver (invalid while it's in the matrix)
         while(true) {
             // API(cogno): what if the struct doesn't have operator equals?
             // API(cogno): instead of storing the key, if we store the hash we can check very easily if two elements are equal. The 2 main problems are 1. cache locality due to hash size and 2. hash collisions which should be less than 1 in a gagillion so it shouldn't be a huge deal
@@ -132,12 +135,15 @@ void map_insert(HashMap<T, U>* map, T key, U value) {
             int next_index = current_finder->next_finder_index;
             if(next_index == MAP_INVALID_INDEX) break;
             current_finder = &map->solver[next_index];
+            current_solver_index = next_index;
         }
         
         // value is new, add to collision queue in the solver
+        int new_chain_end = array_append(&map->solver, {}); // extend collision chain by 1
+        if(current_solver_index != MAP_INVALID_INDEX) current_finder = &map->solver[current_solver_index]; // the append might have moved the solver, the old pointer is not valid anymore
         current_finder->key = key;
         current_finder->value = value;
-        current_finder->next_finder_index = array_append(&map->solver, {}); // extend collision chain by 1
+        current_finder->next_finder_index = new_chain_end;
     }
 }
 
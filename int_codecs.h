@@ -0,0 +1,256 @@
+#pragma once
+#define GYO_INT_CODECS
+
+/*
+In this file:
+- bulk encoders/decoders for arrays of integers, to make indices (and any other integer heavy data) a lot smaller:
+  - LEB128 varints (same format as str_builder_append_varint), for u32 and u64, good for any distribution of values
+  - Stream VByte, for u32 only, where the sizes and the bytes of the values are stored separately so 4 values at a time can be decoded with SIMD
+- delta_encode/delta_decode, to turn sorted values into small gaps
+- zigzag_encode/zigzag_decode for arrays, to keep small negative values small
+
+Each encoder writes how many values there are, then the values. Decoders APPEND the values to the array you give them,
+and return false (without reading out of bounds) if the data is truncated or corrupted.
+
+Example:
+// sorted ids -> small gaps -> 1 byte each most of the time
+delta_encode(ids.ptr, ids.size);
+str_builder_append_stream_vbyte(&b, ids.ptr, ids.size);
+...
+Array<u32> ids = make_array<u32>(100);
+if(!str_parser_get_stream_vbyte(&p, &ids)) { ...corrupted data... }
+delta_decode(ids.ptr, ids.size);
+*/
+
+#ifndef DISABLE_INCLUDES
+    #include <string.h> // for memcpy
+    #include <smmintrin.h> // for sse up to 4.1
+#endif
+
+#ifndef GYOFIRST
+    #include "first.h"
+#endif
+
+#ifndef GYO_ARRAY
+    #include "array.h"
+#endif
+
+#ifndef GYO_STR
+    #include "str.h"
+#endif
+
+//
+// delta
+//
+
+// each value becomes the difference from the previous one (start is the value "before" the first).
+// Unsorted values work too (the differences just wrap around), but then zigzag them so negative gaps stay small.
+void delta_encode(u32* values, s32 count, u32 start) {
+    u32 prev = start;
+    for(s32 i = 0; i < count; i++) {
+        u32 value = values[i];
+        values[i] = value - prev;
+        prev = value;
+    }
+}
+void delta_encode(u32* values, s32 count) { delta_encode(values, count, 0); }
+
+void delta_encode(u64* values, s32 count, u64 start) {
+    u64 prev = start;
+    for(s32 i = 0; i < count; i++) {
+        u64 value = values[i];
+        values[i] = value - prev;
+        prev = value;
+    }
+}
+void delta_encode(u64* values, s32 count) { delta_encode(values, count, 0); }
+
+// the opposite of delta_encode, a prefix sum (4 at a time with SIMD)
+void delta_decode(u32* values, s32 count, u32 start) {
+    __m128i prev = _mm_set1_epi32((int)start);
+    s32 i = 0;
+    for(; i + 4 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128((__m128i*)(values + i));
+        v = _mm_add_epi32(v, _mm_slli_si128(v, 4)); // [a, a+b, b+c, c+d]
+        v = _mm_add_epi32(v, _mm_slli_si128(v, 8)); // [a, a+b, a+b+c, a+b+c+d]
+        v = _mm_add_epi32(v, prev);
+        _mm_storeu_si128((__m128i*)(values + i), v);
+        prev = _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 3, 3)); // broadcast the last one for the next 4
+    }
+    u32 last = (u32)_mm_cvtsi128_si32(prev);
+    for(; i < count; i++) {
+        last += values[i];
+        values[i] = last;
+    }
+}
+void delta_decode(u32* values, s32 count) { delta_decode(values, count, 0); }
+
+void delta_decode(u64* values, s32 count, u64 start) {
+    u64 last = start;
+    for(s32 i = 0; i < count; i++) {
+        last += values[i];
+        values[i] = last;
+    }
+}
+void delta_decode(u64* values, s32 count) { delta_decode(values, count, 0); }
+
+//
+// zigzag (see zigzag_encode in str.h), out can be the same memory as values
+//
+void zigzag_encode(s32* values, u32* out, s32 count) { for(s32 i = 0; i < count; i++) out[i] = ((u32)values[i] << 1) ^ (u32)(values[i] >> 31); }
+void zigzag_decode(u32* values, s32* out, s32 count) { for(s32 i = 0; i < count; i++) out[i] = (s32)(values[i] >> 1) ^ -(s32)(values[i] & 1); }
+void zigzag_encode(s64* values, u64* out, s32 count) { for(s32 i = 0; i < count; i++) out[i] = zigzag_encode(values[i]); }
+void zigzag_decode(u64* values, s64* out, s32 count) { for(s32 i = 0; i < count; i++) out[i] = zigzag_decode(values[i]); }
+
+//
+// LEB128
+//
+#define _VARINT_BLOCK_SIZE 256
+
+template<typename T>
+void _str_builder_append_varints(StrBuilder* b, T* values, s32 count) {
+    str_builder_append_varint(b, count);
+    // we reserve space for a block of values at a time and write them directly, instead of appending one by one
+    for(s32 i = 0; i < count; i += _VARINT_BLOCK_SIZE) {
+        s32 block = min(_VARINT_BLOCK_SIZE, count - i);
+        str_builder_reserve(b, block * 10);
+        u8* dest = b->ptr + b->size;
+        for(s32 j = 0; j < block; j++) dest += varint_write(dest, values[i + j]);
+        b->size = (s32)(dest - b->ptr);
+    }
+}
+void str_builder_append_varints(StrBuilder* b, u32* values, s32 count) { _str_builder_append_varints(b, values, count); }
+void str_builder_append_varints(StrBuilder* b, u64* values, s32 count) { _str_builder_append_varints(b, values, count); }
+
+// 16 bytes, each a value, to 16 integers
+inline void _varint_widen_16(__m128i bytes, u32* dest) {
+    for(int i = 0; i < 4; i++) {
+        _mm_storeu_si128((__m128i*)(dest + i * 4), _mm_cvtepu8_epi32(bytes));
+        bytes = _mm_srli_si128(bytes, 4);
+    }
+}
+inline void _varint_widen_16(__m128i bytes, u64* dest) {
+    for(int i = 0; i < 8; i++) {
+        _mm_storeu_si128((__m128i*)(dest + i * 2), _mm_cvtepu8_epi64(bytes));
+        bytes = _mm_srli_si128(bytes, 2);
+    }
+}
+
+template<typename T>
+bool _str_parser_get_varints(StrParser* p, Array<T>* out, u64 max_value) {
+    u64 count;
+    // every value takes at least 1 byte, so corrupted data can't make us allocate GBs of memory
+    if(!str_parser_get_varint(p, &count) || count > (u64)p->size) return false;
+    array_reserve(out, (s32)count);
+    T* dest = out->ptr + out->size;
+    s32 left = (s32)count;
+    while(left > 0) {
+        if(left >= 16 && p->size >= 16) {
+            // SIMD fast path: every value < 128 is a single byte without the high bit,
+            // so we widen 16 of them at a time and keep the ones before the first multi byte value
+            __m128i bytes = _mm_loadu_si128((__m128i*)p->ptr);
+            u32 multi_byte = (u32)_mm_movemask_epi8(bytes);
+            s32 singles = multi_byte == 0 ? 16 : _bit_scan_forward_u64(multi_byte);
+            if(singles > 0) {
+                _varint_widen_16(bytes, dest); // we have space for 16 even if we keep less
+                dest += singles;
+                left -= singles;
+                str_parser_advance(p, singles);
+                continue;
+            }
+        }
+        u64 value;
+        if(!str_parser_get_varint(p, &value) || value > max_value) return false;
+        *dest++ = (T)value;
+        left--;
+    }
+    out->size += (s32)count;
+    return true;
+}
+bool str_parser_get_varints(StrParser* p, Array<u32>* out) { return _str_parser_get_varints(p, out, MAX_U32); }
+bool str_parser_get_varints(StrParser* p, Array<u64>* out) { return _str_parser_get_varints(p, out, MAX_U64); }
+
+//
+// Stream VByte (Lemire et al.), each group of 4 values has a control byte with 2 bits per value for its size (1 to 4 bytes).
+// The control bytes are all stored first and the values after, so from a control byte we know where the bytes
+// of 4 values are and a single shuffle puts them in place.
+//
+struct _StreamVByteTables {
+    u8 shuffle[256][16]; // for each control byte, where each byte of the 4 values comes from
+    u8 length[256];      // for each control byte, how many bytes the 4 values take
+
+    constexpr _StreamVByteTables() : shuffle(), length() {
+        for(int control = 0; control < 256; control++) {
+            int offset = 0;
+            for(int value = 0; value < 4; value++) {
+                int size = ((control >> (2 * value)) & 3) + 1;
+                for(int byte = 0; byte < 4; byte++) {
+                    // an index with the high bit set makes the shuffle write a 0
+                    shuffle[control][value * 4 + byte] = byte < size ? (u8)(offset + byte) : 0xFF;
+                }
+                offset += size;
+            }
+            length[control] = (u8)offset;
+        }
+    }
+};
+constexpr _StreamVByteTables _STREAM_VBYTE_TABLES = _StreamVByteTables();
+
+inline s32 _stream_vbyte_value_size(u8* control, s64 index) { return ((control[index / 4] >> (2 * (index % 4))) & 3) + 1; }
+
+void str_builder_append_stream_vbyte(StrBuilder* b, u32* values, s32 count) {
+    ASSERT(count <= MAX_S32 / 5, "too many values (%) for a single stream", count);
+    str_builder_append_varint(b, count);
+    s32 control_size = (count + 3) / 4;
+    str_builder_reserve(b, control_size + count * 4); // the worst case, every value is 4 bytes
+    u8* control = b->ptr + b->size;
+    u8* data = control + control_size;
+    memset(control, 0, control_size);
+    for(s32 i = 0; i < count; i++) {
+        u32 value = values[i];
+        s32 code = (value > 0xFF) + (value > 0xFFFF) + (value > 0xFFFFFF);
+        control[i / 4] |= code << (2 * (i % 4));
+        memcpy(data, &value, sizeof(u32)); // little endian, so the bytes we keep are the first ones
+        data += code + 1;
+    }
+    b->size = (s32)(data - b->ptr);
+}
+
+bool str_parser_get_stream_vbyte(StrParser* p, Array<u32>* out) {
+    u64 count;
+    if(!str_parser_get_varint(p, &count) || count > (u64)p->size) return false;
+    s64 control_size = (count + 3) / 4;
+    if(control_size > p->size) return false;
+
+    // find out how big the data is first, so the decoding loop doesn't have to check anything
+    u8* control = p->ptr;
+    s64 groups = count / 4;
+    s64 data_size = 0;
+    for(s64 g = 0; g < groups; g++) data_size += _STREAM_VBYTE_TABLES.length[control[g]];
+    for(s64 i = groups * 4; i < (s64)count; i++) data_size += _stream_vbyte_value_size(control, i);
+    if(control_size + data_size > p->size) return false;
+
+    array_reserve(out, (s32)count);
+    u32* dest = out->ptr + out->size;
+    u8* data = control + control_size;
+    u8* data_end = data + data_size;
+    s64 g = 0;
+    for(; g < groups && data_end - data >= 16; g++) { // near the end we can't load 16 bytes anymore
+        __m128i bytes = _mm_loadu_si128((__m128i*)data);
+        __m128i shuffle = _mm_loadu_si128((__m128i*)_STREAM_VBYTE_TABLES.shuffle[control[g]]);
+        _mm_storeu_si128((__m128i*)dest, _mm_shuffle_epi8(bytes, shuffle));
+        data += _STREAM_VBYTE_TABLES.length[control[g]];
+        dest += 4;
+    }
+    for(s64 i = g * 4; i < (s64)count; i++) {
+        s32 size = _stream_vbyte_value_size(control, i);
+        u32 value = 0;
+        memcpy(&value, data, size);
+        data += size;
+        *dest++ = value;
+    }
+
+    out->size += (s32)count;
+    str_parser_advance(p, (s32)(control_size + data_size));
+    return true;
+}
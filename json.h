@@ -0,0 +1,570 @@
+#pragma once
+#define GYO_JSON
+
+/*
+In this file:
+- an on-demand JSON reader: json_parse only indexes where the structure is ({ } [ ] : , and the quotes of strings),
+  64 bytes at a time with SIMD (4 SSE loads each), then you navigate the document and only the values you ask for get parsed.
+  Every { and [ knows where it ends, so the subtrees you don't need are skipped in O(1).
+  Strings are str views into your input (no copies), so keep it alive while you use the document.
+- JsonWriter, to write JSON into a StrBuilder
+
+Example:
+JsonDocument doc;
+if(!json_parse(text, &doc)) { ...not json... }
+defer { json_free(&doc); };
+JsonValue users;
+if(json_find(json_root(&doc), "users", &users)) {
+    JsonIterator it = json_iterate(users);
+    JsonValue user;
+    while(json_next(&it, &user)) {
+        JsonValue name;
+        str name_str;
+        if(json_find(user, "name", &name) && json_get_str(name, &name_str)) print(name_str);
+    }
+}
+
+StrBuilder b = make_str_builder();
+JsonWriter w = make_json_writer(&b);
+json_begin_object(&w);
+json_write_key(&w, "name"); json_write(&w, "cogno");
+json_write_key(&w, "scores");
+json_begin_array(&w); json_write(&w, 10); json_write(&w, 2.5); json_end_array(&w);
+json_end_object(&w);
+
+NOTE: json_parse only checks that brackets are balanced and strings are closed, the rest of the syntax is checked
+while you read the values you need (every function returns false on something that's not valid json).
+Keys are compared as they are written in the input, with their escape sequences (if any) NOT decoded.
+*/
+
+#ifndef DISABLE_INCLUDES
+    #include <string.h>    // for memcmp
+    #include <smmintrin.h> // for sse up to 4.1
+#endif
+
+#ifndef GYOFIRST
+    #include "first.h"
+#endif
+
+#ifndef GYO_ALLOCATORS
+    #include "allocators.h"
+#endif
+
+#ifndef GYO_ARRAY
+    #include "array.h"
+#endif
+
+#ifndef GYO_STR
+    #include "str.h"
+#endif
+
+ENUM(JsonType,
+    INVALID,
+    OBJECT,
+    ARRAY,
+    STRING,
+    NUMBER,
+    BOOLEAN,
+    NULL_VALUE
+);
+
+struct JsonDocument {
+    str input;
+    Array<s32> structurals; // byte offset of every { } [ ] : , and quote (opening and closing) outside of strings
+    Array<s32> jumps;       // for each { and [, the index (in structurals) of its } or ]
+};
+
+struct JsonValue {
+    JsonDocument* doc;
+    s32 index; // in doc->structurals, where the value is (objects, arrays, strings) or what comes right after it (numbers, true, false, null)
+    s32 start; // byte offset of the first character of the value
+};
+
+//
+// stage 1, finding the structure 64 bytes at a time (the algorithm is the same as simdjson)
+//
+
+// 64 bytes -> bitmask of the bytes equal to c (bit i is byte i)
+inline u64 _json_eq_mask(__m128i* chunks, char c) {
+    __m128i target = _mm_set1_epi8(c);
+    u64 mask = 0;
+    for(int i = 0; i < 4; i++) mask |= (u64)(u32)_mm_movemask_epi8(_mm_cmpeq_epi8(chunks[i], target)) << (16 * i);
+    return mask;
+}
+
+// bit i of the result is the xor of bits 0..i, so between an opening and a closing quote every bit is 1
+inline u64 _json_prefix_xor(u64 bits) {
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+// which characters are escaped by a backslash, odd sequences of backslashes escape the next character, even ones don't.
+// escape_carry says if the first character of this block is escaped by the end of the last block.
+inline u64 _json_escaped_mask(u64 backslashes, u64* escape_carry) {
+    const u64 EVEN_BITS = 0x5555555555555555;
+    backslashes &= ~*escape_carry;
+    u64 follows_escape = backslashes << 1 | *escape_carry;
+    u64 odd_sequence_starts = backslashes & ~EVEN_BITS & ~follows_escape;
+    u64 sequences_starting_on_even_bits = odd_sequence_starts + backslashes;
+    *escape_carry = sequences_starting_on_even_bits < odd_sequence_starts; // the sum overflowed, the next block starts escaped
+    u64 invert_mask = sequences_starting_on_even_bits << 1;
+    return (EVEN_BITS ^ invert_mask) & follows_escape;
+}
+
+bool _json_index(JsonDocument* doc) {
+    u8* ptr = doc->input.ptr;
+    s32 size = doc->input.size;
+    u64 escape_carry = 0;
+    u64 in_string_carry = 0; // all 1s if the last block ended inside a string
+
+    for(s32 block_start = 0; block_start < size; block_start += 64) {
+        u8 padded[64];
+        u8* block = ptr + block_start;
+        if(size - block_start < 64) {
+            // the last block, we can't read past the end of the input
+            memset(padded, ' ', 64);
+            memcpy(padded, block, size - block_start);
+            block = padded;
+        }
+        __m128i chunks[4];
+        for(int i = 0; i < 4; i++) chunks[i] = _mm_loadu_si128((__m128i*)(block + 16 * i));
+
+        u64 escaped = _json_escaped_mask(_json_eq_mask(chunks, '\\'), &escape_carry);
+        u64 quotes = _json_eq_mask(chunks, '"') & ~escaped;
+        u64 in_string = _json_prefix_xor(quotes) ^ in_string_carry;
+        in_string_carry = (u64)((s64)in_string >> 63);
+        u64 operators = _json_eq_mask(chunks, '{') | _json_eq_mask(chunks, '}') | _json_eq_mask(chunks, '[')
+                      | _json_eq_mask(chunks, ']') | _json_eq_mask(chunks, ':') | _json_eq_mask(chunks, ',');
+        u64 structurals = (operators & ~in_string) | quotes;
+
+        array_reserve(&doc->structurals, 64);
+        s32* dest = doc->structurals.ptr + doc->structurals.size;
+        while(structurals != 0) {
+            *dest++ = block_start + _bit_scan_forward_u64(structurals);
+            structurals &= structurals - 1;
+        }
+        doc->structurals.size = (s32)(dest - doc->structurals.ptr);
+    }
+    if(in_string_carry != 0) return false; // a string never ends
+
+    // match every { and [ with its } or ]
+    array_reserve(&doc->jumps, doc->structurals.size);
+    doc->jumps.size = doc->structurals.size;
+    Array<s32> open = make_array<s32>(64, doc->structurals.alloc);
+    defer { array_free(&open); };
+    for(s32 i = 0; i < doc->structurals.size; i++) {
+        u8 c = ptr[doc->structurals[i]];
+        doc->jumps[i] = -1;
+        if(c == '{' || c == '[') array_append(&open, i);
+        else if(c == '}' || c == ']') {
+            if(open.size == 0) return false;
+            s32 opener = array_pop(&open);
+            if(ptr[doc->structurals[opener]] != (c == '}' ? '{' : '[')) return false;
+            doc->jumps[opener] = i;
+        }
+    }
+    return open.size == 0;
+}
+
+// indexes the document, returns false if it's clearly not json (unbalanced brackets, strings that never end).
+// Call json_free when you're done, even if it failed.
+bool json_parse(str input, JsonDocument* out, Allocator alloc) {
+    JsonDocument doc = {};
+    doc.input = input;
+    doc.structurals = make_array<s32>(input.size / 4 + 64, alloc); // usually enough to never grow
+    doc.jumps = make_array<s32>(16, alloc);
+    *out = doc;
+    return _json_index(out);
+}
+bool json_parse(str input, JsonDocument* out) { return json_parse(input, out, default_allocator); }
+
+void json_free(JsonDocument* doc) {
+    array_free(&doc->structurals);
+    array_free(&doc->jumps);
+}
+
+//
+// navigation
+//
+
+inline bool _json_is_space(u8 c) { return c == ' ' || c == '\n' || c == '\r' || c == '\t'; }
+
+inline s32 _json_skip_spaces(JsonDocument* doc, s32 offset) {
+    while(offset < doc->input.size && _json_is_space(doc->input.ptr[offset])) offset++;
+    return offset;
+}
+
+// the structural character at index (0 if there's none)
+inline u8 _json_char(JsonDocument* doc, s32 index) {
+    if(index < 0 || index >= doc->structurals.size) return 0;
+    return doc->input.ptr[doc->structurals[index]];
+}
+
+inline JsonValue _json_make_value(JsonDocument* doc, s32 index, s32 start) {
+    JsonValue v = {};
+    v.doc = doc;
+    v.index = index;
+    v.start = _json_skip_spaces(doc, start);
+    return v;
+}
+
+// byte offset where a value ends (exclusive)
+inline s32 _json_end(JsonValue v) {
+    if(v.index >= v.doc->structurals.size) return v.doc->input.size;
+    return v.doc->structurals[v.index];
+}
+
+// index of the first structural after the value, or -1 if it's malformed
+s32 _json_after(JsonValue v) {
+    if(v.start >= v.doc->input.size) return -1;
+    u8 c = v.doc->input.ptr[v.start];
+    bool is_indexed = v.index < v.doc->structurals.size && v.doc->structurals[v.index] == v.start;
+    if(c == '{' || c == '[') return is_indexed ? v.doc->jumps[v.index] + 1 : -1;
+    if(c == '"') return is_indexed ? v.index + 2 : -1;
+    return v.index; // numbers/true/false/null are not indexed, so what follows is already here
+}
+
+JsonValue json_root(JsonDocument* doc) { return _json_make_value(doc, 0, 0); }
+
+JsonType json_type(JsonValue v) {
+    if(v.doc == NULL || v.start >= v.doc->input.size) return JsonType::INVALID;
+    u8 c = v.doc->input.ptr[v.start];
+    switch(c) {
+        case '{': return JsonType::OBJECT;
+        case '[': return JsonType::ARRAY;
+        case '"': return JsonType::STRING;
+        case 't': case 'f': return JsonType::BOOLEAN;
+        case 'n': return JsonType::NULL_VALUE;
+        default: return (c == '-' || u8_is_digit(c)) ? JsonType::NUMBER : JsonType::INVALID;
+    }
+}
+
+// goes through the elements of an array or the members of an object, in order
+struct JsonIterator {
+    JsonDocument* doc;
+    s32 separator; // index of the [ { or , right before the next element
+    bool is_object;
+};
+
+JsonIterator json_iterate(JsonValue container) {
+    JsonIterator it = {};
+    it.doc = container.doc;
+    JsonType type = json_type(container);
+    it.is_object = type == JsonType::OBJECT;
+    bool is_indexed = container.index < it.doc->structurals.size && it.doc->structurals[container.index] == container.start;
+    it.separator = (type == JsonType::OBJECT || type == JsonType::ARRAY) && is_indexed ? container.index : -1; // -1 means no elements
+    return it;
+}
+
+// gives the next value (and its key, if it's an object), returns false at the end (or on malformed json)
+bool json_next(JsonIterator* it, JsonValue* out_value, str* out_key) {
+    JsonDocument* doc = it->doc;
+    s32 separator = it->separator;
+    u8 c = _json_char(doc, separator);
+    if(c != '{' && c != '[' && c != ',') return false; // the end
+    it->separator = -1; // if anything goes wrong, we stop here
+
+    JsonValue value;
+    if(it->is_object) {
+        if(c == '{' && _json_char(doc, separator + 1) == '}') return false; // empty object
+        if(_json_char(doc, separator + 1) != '"' || _json_char(doc, separator + 2) != '"' || _json_char(doc, separator + 3) != ':') return false;
+        s32 key_start = doc->structurals[separator + 1] + 1;
+        if(out_key != NULL) *out_key = str(doc->input.ptr + key_start, doc->structurals[separator + 2] - key_start);
+        value = _json_make_value(doc, separator + 4, doc->structurals[separator + 3] + 1);
+    } else {
+        value = _json_make_value(doc, separator + 1, doc->structurals[separator] + 1);
+        if(c == '[' && value.start < doc->input.size && doc->input.ptr[value.start] == ']') return false; // empty array
+    }
+
+    if(json_type(value) == JsonType::INVALID) return false; // like [1,] or {"a":}
+    s32 after = _json_after(value);
+    u8 next = _json_char(doc, after);
+    if(next != ',' && next != (it->is_object ? '}' : ']')) return false;
+    it->separator = after;
+    *out_value = value;
+    return true;
+}
+bool json_next(JsonIterator* it, JsonValue* out_value) { return json_next(it, out_value, NULL); }
+
+// finds the member of an object with the given key
+bool json_find(JsonValue object, str key, JsonValue* out) {
+    if(json_type(object) != JsonType::OBJECT) return false;
+    JsonIterator it = json_iterate(object);
+    JsonValue value;
+    str value_key;
+    while(json_next(&it, &value, &value_key)) {
+        if(value_key.size == key.size && memcmp(value_key.ptr, key.ptr, key.size) == 0) {
+            *out = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+// finds the element of an array at the given index
+bool json_at(JsonValue array, s32 index, JsonValue* out) {
+    if(json_type(array) != JsonType::ARRAY) return false;
+    JsonIterator it = json_iterate(array);
+    JsonValue value;
+    for(s32 i = 0; json_next(&it, &value); i++) {
+        if(i == index) {
+            *out = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+// how many elements (or members) an array (or object) has
+s32 json_count(JsonValue container) {
+    JsonIterator it = json_iterate(container);
+    JsonValue value;
+    s32 count = 0;
+    while(json_next(&it, &value)) count++;
+    return count;
+}
+
+//
+// values
+//
+
+// the text of a number/true/false/null, without the spaces after it
+inline StrParser _json_scalar(JsonValue v) {
+    s32 end = _json_end(v);
+    while(end > v.start && _json_is_space(v.doc->input.ptr[end - 1])) end--;
+    return make_str_parser(v.doc->input.ptr + v.start, max(end - v.start, 0));
+}
+
+// the string as it is written in the input (a view, no copies), escape sequences (like \n or \") are NOT decoded, see json_unescape
+bool json_get_str(JsonValue v, str* out) {
+    if(json_type(v) != JsonType::STRING || _json_char(v.doc, v.index + 1) != '"') return false;
+    s32 start = v.start + 1;
+    *out = str(v.doc->input.ptr + start, v.doc->structurals[v.index + 1] - start);
+    return true;
+}
+
+bool json_get_s64(JsonValue v, s64* out) {
+    StrParser p = _json_scalar(v);
+    return json_type(v) == JsonType::NUMBER && str_parser_parse_s64(&p, out) && p.size == 0;
+}
+
+bool json_get_u64(JsonValue v, u64* out) {
+    StrParser p = _json_scalar(v);
+    return json_type(v) == JsonType::NUMBER && str_parser_parse_u64(&p, out) && p.size == 0;
+}
+
+bool json_get_f64(JsonValue v, f64* out) {
+    StrParser p = _json_scalar(v);
+    return json_type(v) == JsonType::NUMBER && str_parser_parse_f64(&p, out) && p.size == 0;
+}
+
+bool json_get_bool(JsonValue v, bool* out) {
+    StrParser p = _json_scalar(v);
+    return str_parser_parse_bool(&p, out) && p.size == 0;
+}
+
+bool json_is_null(JsonValue v) {
+    StrParser p = _json_scalar(v);
+    return str_parser_to_str(p) == str("null");
+}
+
+inline s32 _json_hex_digit(u8 c) {
+    if(c >= '0' && c <= '9') return c - '0';
+    if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+inline bool _json_parse_hex4(StrParser* p, u32* out) {
+    if(p->size < 4) return false;
+    u32 value = 0;
+    for(int i = 0; i < 4; i++) {
+        s32 digit = _json_hex_digit(p->ptr[i]);
+        if(digit < 0) return false;
+        value = value * 16 + digit;
+    }
+    str_parser_advance(p, 4);
+    *out = value;
+    return true;
+}
+
+// decodes the escape sequences of a string from json_get_str (\n, \", è ...), appending the result (utf8) to out
+bool json_unescape(str raw, StrBuilder* out) {
+    StrParser p = make_str_parser(raw);
+    while(p.size > 0) {
+        // copy everything up to the next backslash in one go
+        s32 run = 0;
+        while(run < p.size && p.ptr[run] != '\\') run++;
+        str_builder_append(out, str(p.ptr, run));
+        str_parser_advance(&p, run);
+        if(p.size == 0) break;
+
+        if(p.size < 2) return false;
+        u8 escaped = p.ptr[1];
+        str_parser_advance(&p, 2);
+        switch(escaped) {
+            case '"':  str_builder_append(out, '"');  break;
+            case '\\': str_builder_append(out, '\\'); break;
+            case '/':  str_builder_append(out, '/');  break;
+            case 'b':  str_builder_append(out, '\b'); break;
+            case 'f':  str_builder_append(out, '\f'); break;
+            case 'n':  str_builder_append(out, '\n'); break;
+            case 'r':  str_builder_append(out, '\r'); break;
+            case 't':  str_builder_append(out, '\t'); break;
+            case 'u': {
+                u32 codepoint;
+                if(!_json_parse_hex4(&p, &codepoint)) return false;
+                if(codepoint >= 0xD800 && codepoint <= 0xDBFF) {
+                    // utf16 surrogate pair, the second half must follow
+                    u32 low;
+                    if(p.size < 2 || p.ptr[0] != '\\' || p.ptr[1] != 'u') return false;
+                    str_parser_advance(&p, 2);
+                    if(!_json_parse_hex4(&p, &low) || low < 0xDC00 || low > 0xDFFF) return false;
+                    codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                } else if(codepoint >= 0xDC00 && codepoint <= 0xDFFF) return false;
+                u8 buff[4];
+                s32 size = 0;
+                if(codepoint < 0x80) buff[size++] = (u8)codepoint;
+                else if(codepoint < 0x800) {
+                    buff[size++] = (u8)(0xC0 | (codepoint >> 6));
+                    buff[size++] = (u8)(0x80 | (codepoint & 0x3F));
+                } else if(codepoint < 0x10000) {
+                    buff[size++] = (u8)(0xE0 | (codepoint >> 12));
+                    buff[size++] = (u8)(0x80 | ((codepoint >> 6) & 0x3F));
+                    buff[size++] = (u8)(0x80 | (codepoint & 0x3F));
+                } else {
+                    buff[size++] = (u8)(0xF0 | (codepoint >> 18));
+                    buff[size++] = (u8)(0x80 | ((codepoint >> 12) & 0x3F));
+                    buff[size++] = (u8)(0x80 | ((codepoint >> 6) & 0x3F));
+                    buff[size++] = (u8)(0x80 | (codepoint & 0x3F));
+                }
+                str_builder_append(out, str(buff, size));
+                break;
+            }
+            default: return false;
+        }
+    }
+    return true;
+}
+
+//
+// writer
+//
+#define GYO_JSON_MAX_DEPTH 64
+
+struct JsonWriter {
+    StrBuilder* b;
+    s32 depth;
+    u64 has_items; // one bit per depth, if the current object/array already has something in it (so the next one needs a ',')
+    bool after_key;
+};
+
+JsonWriter make_json_writer(StrBuilder* b) {
+    JsonWriter w = {};
+    w.b = b;
+    return w;
+}
+
+void _json_before_value(JsonWriter* w) {
+    if(w->after_key) {
+        w->after_key = false;
+        return;
+    }
+    if(w->depth == 0) return;
+    u64 bit = 1ull << (w->depth - 1);
+    if(w->has_items & bit) str_builder_append(w->b, ',');
+    w->has_items |= bit;
+}
+
+void _json_write_begin(JsonWriter* w, char c) {
+    _json_before_value(w);
+    ASSERT(w->depth < GYO_JSON_MAX_DEPTH, "json too deep, at most % nested objects/arrays can be written", GYO_JSON_MAX_DEPTH);
+    str_builder_append(w->b, c);
+    w->depth++;
+    w->has_items &= ~(1ull << (w->depth - 1));
+}
+
+void _json_write_end(JsonWriter* w, char c) {
+    ASSERT(w->depth > 0 && !w->after_key, "closing an object/array which was never opened (or a key without a value)");
+    w->depth--;
+    str_builder_append(w->b, c);
+}
+
+void json_begin_object(JsonWriter* w) { _json_write_begin(w, '{'); }
+void json_end_object(JsonWriter* w)   { _json_write_end(w, '}'); }
+void json_begin_array(JsonWriter* w)  { _json_write_begin(w, '['); }
+void json_end_array(JsonWriter* w)    { _json_write_end(w, ']'); }
+
+// writes the string with quotes, escaping what json requires
+void _json_append_string(StrBuilder* b, str s) {
+    str_builder_append(b, '"');
+    s32 i = 0;
+    while(i < s.size) {
+        // PERF: find the next character to escape 16 at a time, most strings don't have any
+        s32 run = i;
+        bool found = false;
+        while(!found && run + 16 <= s.size) {
+            __m128i chunk = _mm_loadu_si128((__m128i*)(s.ptr + run));
+            __m128i is_control = _mm_cmpeq_epi8(_mm_max_epu8(chunk, _mm_set1_epi8(0x1F)), _mm_set1_epi8(0x1F)); // <= 0x1F
+            __m128i to_escape = _mm_or_si128(is_control, _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('"')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\'))));
+            u32 mask = (u32)_mm_movemask_epi8(to_escape);
+            found = mask != 0;
+            run += found ? _bit_scan_forward_u64(mask) : 16;
+        }
+        if(!found) while(run < s.size && s.ptr[run] >= 0x20 && s.ptr[run] != '"' && s.ptr[run] != '\\') run++;
+        str_builder_append(b, str(s.ptr + i, run - i));
+        if(run == s.size) break;
+
+        u8 c = s.ptr[run];
+        switch(c) {
+            case '"':  str_builder_append(b, "\\\""); break;
+            case '\\': str_builder_append(b, "\\\\"); break;
+            case '\n': str_builder_append(b, "\\n");  break;
+            case '\r': str_builder_append(b, "\\r");  break;
+            case '\t': str_builder_append(b, "\\t");  break;
+            default: {
+                const char* HEX = "0123456789abcdef";
+                char escape[6] = {'\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 0xF]};
+                str_builder_append(b, str((u8*)escape, 6));
+            }
+        }
+        i = run + 1;
+    }
+    str_builder_append(b, '"');
+}
+
+void json_write_key(JsonWriter* w, str key) {
+    ASSERT(!w->after_key, "two keys in a row, the first one has no value");
+    _json_before_value(w);
+    _json_append_string(w->b, key);
+    str_builder_append(w->b, ':');
+    w->after_key = true;
+}
+
+void json_write(JsonWriter* w, str value)         { _json_before_value(w); _json_append_string(w->b, value); }
+void json_write(JsonWriter* w, const char* value) { json_write(w, str(value)); }
+void json_write(JsonWriter* w, bool value)        { _json_before_value(w); str_builder_append(w->b, value ? "true" : "false"); }
+void json_write(JsonWriter* w, s64 value)         { _json_before_value(w); str_builder_append(w->b, value); }
+void json_write(JsonWriter* w, u64 value)         { _json_before_value(w); str_builder_append(w->b, value); }
+void json_write(JsonWriter* w, s32 value)         { json_write(w, (s64)value); }
+void json_write(JsonWriter* w, u32 value)         { json_write(w, (u64)value); }
+void json_write_null(JsonWriter* w)               { _json_before_value(w); str_builder_append(w->b, "null"); }
+
+void json_write(JsonWriter* w, f64 value) {
+    _json_before_value(w);
+    if(value - value != 0) { // inf or nan
+        str_builder_append(w->b, "null"); // json has no inf/nan
+        return;
+    }
+    // the shortest of the 2 which reads back as the same number
+    char buff[32];
+    snprintf(buff, sizeof(buff), "%.15g", value);
+    if(strtod(buff, NULL) != value) snprintf(buff, sizeof(buff), "%.17g", value);
+    str_builder_append(w->b, buff);
+}
+void json_write(JsonWriter* w, f32 value) { json_write(w, (f64)value); }
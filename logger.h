@@ -0,0 +1,438 @@
+#pragma once
+#define GYO_LOGGER
+
+/*
+In this file:
+- LOG_TRACE, LOG_DEBUG, LOG_INFO, LOG_WARN and LOG_ERROR, an asynchronous logger using the same format as PRINT
+  (and every printsl_custom you made for your types).
+
+The thread calling LOG_* only copies the inputs (as raw bytes) in a lock-free ring buffer, a background thread
+then formats them and writes them to a file, so logging costs (way) less than a print on hot threads.
+Before logger_start is called (or after logger_stop) LOG_* simply prints to stdout.
+
+Example:
+logger_start("server.log");
+logger_set_rotation(100 * 1024 * 1024, 5); // at 100MB server.log becomes server.log.1, keeping at most 5 old files
+LOG_INFO("client % connected from %", client_id, address);
+LOG_ERROR("request failed after % ms", elapsed);
+logger_stop(); // writes everything left
+
+Every line looks like '[14:03:27.123456] INFO  client 12 connected from 127.0.0.1' (time is UTC).
+
+Levels can be removed at compile time (the inputs are not even evaluated), like ASSERT with NO_ASSERT:
+- NO_LOG removes every LOG_*
+- GYO_LOG_MIN_LEVEL removes every level below it (0 trace, 1 debug, 2 info, 3 warn, 4 error)
+and at runtime with logger_set_min_level.
+
+Inputs are copied as raw bytes and formatted LATER, on another thread. Strings (const char*, str) are copied
+entirely so they're safe, but any other pointer (or struct containing pointers, like Array) will be read
+when the line is written, so it must still be valid. If that's not the case call logger_set_deferred_format(false),
+which formats every line on the calling thread (slower, but always safe).
+*/
+
+#ifndef GYOFIRST
+    #include "first.h"
+#endif
+
+#ifndef GYO_THREADS
+    #include "threads.h"
+#endif
+
+#ifndef DISABLE_INCLUDES
+    #include <stdio.h>
+    #include <string.h>
+    #include <time.h>
+#endif
+
+#ifndef GYO_LOG_MIN_LEVEL
+    #define GYO_LOG_MIN_LEVEL 0
+#endif
+
+#define GYO_LOG_SLOT_SIZE 64 // each line takes as many slots as needed
+#define GYO_LOG_DEFAULT_RING_SIZE (1024 * 1024)
+
+enum LogLevel {
+    LOG_LEVEL_TRACE,
+    LOG_LEVEL_DEBUG,
+    LOG_LEVEL_INFO,
+    LOG_LEVEL_WARN,
+    LOG_LEVEL_ERROR,
+};
+const char* _LOG_LEVEL_NAMES[] = { "TRACE", "DEBUG", "INFO ", "WARN ", "ERROR" };
+
+#if !defined(NO_LOG) && GYO_LOG_MIN_LEVEL <= 0
+#define LOG_TRACE(fmt, ...) _log(LOG_LEVEL_TRACE, _FORMAT_STRING(fmt),##__VA_ARGS__)
+#else
+#define LOG_TRACE(fmt, ...)
+#endif
+
+#if !defined(NO_LOG) && GYO_LOG_MIN_LEVEL <= 1
+#define LOG_DEBUG(fmt, ...) _log(LOG_LEVEL_DEBUG, _FORMAT_STRING(fmt),##__VA_ARGS__)
+#else
+#define LOG_DEBUG(fmt, ...)
+#endif
+
+#if !defined(NO_LOG) && GYO_LOG_MIN_LEVEL <= 2
+#define LOG_INFO(fmt, ...) _log(LOG_LEVEL_INFO, _FORMAT_STRING(fmt),##__VA_ARGS__)
+#else
+#define LOG_INFO(fmt, ...)
+#endif
+
+#if !defined(NO_LOG) && GYO_LOG_MIN_LEVEL <= 3
+#define LOG_WARN(fmt, ...) _log(LOG_LEVEL_WARN, _FORMAT_STRING(fmt),##__VA_ARGS__)
+#else
+#define LOG_WARN(fmt, ...)
+#endif
+
+#if !defined(NO_LOG) && GYO_LOG_MIN_LEVEL <= 4
+#define LOG_ERROR(fmt, ...) _log(LOG_LEVEL_ERROR, _FORMAT_STRING(fmt),##__VA_ARGS__)
+#else
+#define LOG_ERROR(fmt, ...)
+#endif
+
+// what comes first in the slots of each line, followed by the inputs
+struct _LogRecord {
+    void (*decode)(u8* inputs); // NULL if it's just padding to reach the end of the ring
+    s64 time_ns;
+    s32 slot_count;
+    s32 level;
+};
+
+// The ring is a bounded multi-producer single-consumer queue (like Dmitry Vyukov's one): each slot has a sequence number
+// which tells if it's free (== its position) or written (== its position + 1) for the current lap of the ring.
+// Lines taking more than 1 slot claim all of them at once, and never wrap around the end of the ring.
+struct Logger {
+    u8* slots;
+    volatile s64* sequences;
+    s64 slot_count; // power of 2
+
+    alignas(64) volatile s64 enqueue_pos; // written by every thread logging
+    alignas(64) s64 dequeue_pos;          // only used by the writer thread
+
+    volatile s32 running;
+    Thread writer;
+
+    FILE* file;
+    char path[512];
+    s64 file_size;
+    s64 max_file_size; // 0 means never rotate
+    s32 max_files;
+
+    LogLevel min_level;
+    bool immediate_format;
+    bool started;
+};
+
+Logger __logger = {};
+
+inline s64 _log_time_ns() {
+    timespec t;
+    timespec_get(&t, TIME_UTC);
+    return (s64)t.tv_sec * 1000000000 + t.tv_nsec;
+}
+
+inline void _log_print_prefix(s32 level, s64 time_ns) {
+    s64 us = time_ns / 1000;
+    s64 seconds = us / 1000000;
+    _buffer_append("[%02d:%02d:%02d.%06d] %s ", (int)(seconds / 3600 % 24), (int)(seconds / 60 % 60), (int)(seconds % 60), (int)(us % 1000000), _LOG_LEVEL_NAMES[level]);
+}
+
+//
+// how each input is copied into the ring, and then printed from it
+//
+template <typename T>
+struct _LogInput {
+    static_assert(__is_trivially_copyable(T), "LOG_* can only take inputs that can be copied as raw bytes, use logger_set_deferred_format(false) for the others");
+    static s32 size(T&) { return sizeof(T); }
+    static u8* write(u8* dest, T& value) { memcpy(dest, &value, sizeof(T)); return dest + sizeof(T); }
+    static u8* print(u8* src) {
+        alignas(T) u8 storage[sizeof(T)]; // the ring is not aligned for T, copy it out first
+        memcpy(storage, src, sizeof(T));
+        printsl_custom(*(T*)storage);
+        return src + sizeof(T);
+    }
+};
+
+// strings are copied entirely, the caller's memory might be gone by the time we print them
+inline u8* _log_write_string(u8* dest, const u8* data, s32 size) {
+    memcpy(dest, &size, sizeof(size));
+    memcpy(dest + sizeof(size), data, size);
+    return dest + sizeof(size) + size;
+}
+inline u8* _log_print_string(u8* src) {
+    s32 size;
+    memcpy(&size, src, sizeof(size));
+    _print_buffer_append((const char*)src + sizeof(size), size);
+    return src + sizeof(size) + size;
+}
+
+template <>
+struct _LogInput<const char*> {
+    static s32 size(const char*& value) { return sizeof(s32) + (s32)strlen(value); }
+    static u8* write(u8* dest, const char*& value) { return _log_write_string(dest, (const u8*)value, (s32)strlen(value)); }
+    static u8* print(u8* src) { return _log_print_string(src); }
+};
+
+template <>
+struct _LogInput<char*> {
+    static s32 size(char*& value) { return sizeof(s32) + (s32)strlen(value); }
+    static u8* write(u8* dest, char*& value) { return _log_write_string(dest, (const u8*)value, (s32)strlen(value)); }
+    static u8* print(u8* src) { return _log_print_string(src); }
+};
+
+#ifdef GYO_STR
+template <>
+struct _LogInput<str> {
+    static s32 size(str& value) { return sizeof(s32) + value.size; }
+    static u8* write(u8* dest, str& value) { return _log_write_string(dest, value.ptr, value.size); }
+    static u8* print(u8* src) { return _log_print_string(src); }
+};
+#endif
+
+inline s32 _log_inputs_size() { return 0; }
+template <typename T, typename... Types>
+inline s32 _log_inputs_size(T& first, Types&... others) { return _LogInput<T>::size(first) + _log_inputs_size(others...); }
+
+inline void _log_write_inputs(u8*) { }
+template <typename T, typename... Types>
+inline void _log_write_inputs(u8* dest, T& first, Types&... others) {
+    dest = _LogInput<T>::write(dest, first);
+    _log_write_inputs(dest, others...);
+}
+
+template <typename Format, int Index>
+inline void _log_print_inputs(u8*) {
+    _accumulate_format_piece<Format, Index>(); // text after the last input
+}
+template <typename Format, int Index, typename T, typename... Types>
+inline void _log_print_inputs(u8* src) {
+    _accumulate_format_piece<Format, Index>();
+    src = _LogInput<T>::print(src);
+    _log_print_inputs<Format, Index + 1, Types...>(src);
+}
+
+// one for each LOG_* call (and types given), called by the writer thread to format the line
+template <typename Format, typename... Types>
+void _log_decode(u8* inputs) { _log_print_inputs<Format, 0, Types...>(inputs); }
+
+//
+// output file
+//
+
+// the oldest file gets deleted, every other one shifts by 1 (log.txt -> log.txt.1 -> log.txt.2 ...)
+void _logger_rotate() {
+    fclose(__logger.file);
+    char from[530];
+    char to[530];
+    if(__logger.max_files > 0) {
+        snprintf(to, sizeof(to), "%s.%d", __logger.path, __logger.max_files);
+        remove(to);
+        for(int i = __logger.max_files - 1; i >= 1; i--) {
+            snprintf(from, sizeof(from), "%s.%d", __logger.path, i);
+            snprintf(to, sizeof(to), "%s.%d", __logger.path, i + 1);
+            rename(from, to);
+        }
+        snprintf(to, sizeof(to), "%s.1", __logger.path);
+        rename(__logger.path, to);
+    }
+    __logger.file = fopen(__logger.path, "wb");
+    if(__logger.file == NULL) __logger.file = stderr; // better than losing everything
+    __logger.file_size = 0;
+}
+
+// where the writer thread (and immediate formatting) prints, called with the print lock held, always with whole lines
+void _logger_sink(const char* data, int size) {
+    fwrite(data, 1, size, __logger.file);
+    __logger.file_size += size;
+    bool is_real_file = __logger.file != stdout && __logger.file != stderr;
+    if(is_real_file && __logger.max_file_size > 0 && __logger.file_size >= __logger.max_file_size) _logger_rotate();
+}
+
+//
+// ring buffer
+//
+
+// returns the position of slot_count free consecutive slots, waits if the ring is full
+s64 _logger_claim(s32 slot_count) {
+    s64 mask = __logger.slot_count - 1;
+    s64 pos = atomic_load(&__logger.enqueue_pos);
+    while(true) {
+        s64 first = pos & mask;
+        s32 to_claim = first + slot_count > __logger.slot_count ? (s32)(__logger.slot_count - first) : slot_count;
+        s64 last = pos + to_claim - 1;
+
+        // slots are freed in order, so if the last one is free all of them are
+        s64 sequence = atomic_load(&__logger.sequences[last & mask]);
+        if(sequence < last) {
+            // full, the writer still has to get to the previous lap
+            thread_yield();
+            pos = atomic_load(&__logger.enqueue_pos);
+            continue;
+        }
+        if(sequence > last) { pos = atomic_load(&__logger.enqueue_pos); continue; } // another thread got them first
+
+        s64 seen = atomic_compare_exchange(&__logger.enqueue_pos, pos, pos + to_claim);
+        if(seen != pos) { pos = seen; continue; }
+        if(to_claim == slot_count) return pos;
+
+        // the line doesn't fit before the end of the ring, skip what's left and try again from the start
+        auto* padding = (_LogRecord*)(__logger.slots + first * GYO_LOG_SLOT_SIZE);
+        padding->decode = NULL;
+        padding->slot_count = to_claim;
+        atomic_store(&__logger.sequences[first], pos + 1);
+        pos += to_claim;
+    }
+}
+
+// formats every line ready in the ring, returns how many
+s32 _logger_consume() {
+    s64 mask = __logger.slot_count - 1;
+    s32 consumed = 0;
+    while(true) {
+        s64 pos = __logger.dequeue_pos;
+        if(atomic_load(&__logger.sequences[pos & mask]) != pos + 1) return consumed;
+
+        auto* record = (_LogRecord*)(__logger.slots + (pos & mask) * GYO_LOG_SLOT_SIZE);
+        s32 slot_count = record->slot_count;
+        if(record->decode != NULL) {
+            _log_print_prefix(record->level, record->time_ns);
+            record->decode((u8*)(record + 1));
+            printsl_custom('\n');
+            consumed++;
+        }
+
+        // free them for the next lap
+        for(int i = 0; i < slot_count; i++) atomic_store(&__logger.sequences[(pos + i) & mask], pos + i + __logger.slot_count);
+        __logger.dequeue_pos = pos + slot_count;
+    }
+}
+
+void _logger_writer(void*) {
+    __print.sink = _logger_sink; // everything this thread prints goes to the log file
+    print_set_buffer_size(64 * 1024);
+    while(true) {
+        bool running = atomic_load(&__logger.running) != 0;
+        s32 consumed = _logger_consume();
+        if(consumed > 0) {
+            flush_to_stdout();
+            _print_sink_lock();
+            fflush(__logger.file);
+            _print_sink_unlock();
+        } else if(!running) {
+            return;
+        } else {
+            thread_sleep_ms(1);
+        }
+    }
+}
+
+//
+// logging
+//
+
+// formats on the calling thread, used when the logger is not started, deferred formatting is disabled or the line doesn't fit in the ring
+template <typename Format, typename... Types>
+void _log_now(LogLevel level, s64 time_ns, Types... inputs) {
+    _print_begin();
+    if(!__logger.started) {
+        _log_print_prefix(level, time_ns);
+        _accumulate_format<Format, 0>(inputs...);
+        printsl_custom('\n');
+        _print_maybe_flush(true);
+        return;
+    }
+
+    flush_to_stdout(); // whatever this thread printed before goes where it was supposed to go
+    auto old_sink = __print.sink;
+    __print.sink = _logger_sink;
+    _log_print_prefix(level, time_ns);
+    _accumulate_format<Format, 0>(inputs...);
+    printsl_custom('\n');
+    flush_to_stdout();
+    __print.sink = old_sink;
+    __print.at_line_start = true;
+}
+
+template <typename Format, typename... Types>
+void _log(LogLevel level, Format, Types... inputs) {
+    static_assert(_FormatSpecOf<Format>::value.input_count == sizeof...(Types), "the number of '%' in the format string is different from the number of inputs given");
+    if(level < __logger.min_level) return;
+    s64 time_ns = _log_time_ns();
+    if(!__logger.started || __logger.immediate_format) { _log_now<Format>(level, time_ns, inputs...); return; }
+
+    s32 size = sizeof(_LogRecord) + _log_inputs_size(inputs...);
+    s32 slot_count = (size + GYO_LOG_SLOT_SIZE - 1) / GYO_LOG_SLOT_SIZE;
+    if(slot_count > __logger.slot_count / 2) { _log_now<Format>(level, time_ns, inputs...); return; } // huge line, it would block the ring
+
+    s64 pos = _logger_claim(slot_count);
+    s64 first = pos & (__logger.slot_count - 1);
+    auto* record = (_LogRecord*)(__logger.slots + first * GYO_LOG_SLOT_SIZE);
+    record->decode = _log_decode<Format, Types...>;
+    record->time_ns = time_ns;
+    record->slot_count = slot_count;
+    record->level = level;
+    _log_write_inputs((u8*)(record + 1), inputs...);
+    atomic_store(&__logger.sequences[first], pos + 1); // ready for the writer
+}
+
+//
+// configuration
+//
+
+// Starts the background writer, appending to filename (NULL means stdout).
+// ring_size is how many bytes of lines can wait to be written, when it's full LOG_* waits.
+bool logger_start(const char* filename, s32 ring_size = GYO_LOG_DEFAULT_RING_SIZE) {
+    ASSERT(!__logger.started, "logger already started, call logger_stop first");
+    if(filename != NULL) {
+        ASSERT_ALWAYS(strlen(filename) < sizeof(__logger.path), "log file path too long (max % characters)", (s32)sizeof(__logger.path) - 1);
+        __logger.file = fopen(filename, "ab");
+        if(__logger.file == NULL) return false;
+        strcpy(__logger.path, filename);
+        fseek(__logger.file, 0, SEEK_END);
+        __logger.file_size = ftell(__logger.file);
+    } else {
+        __logger.file = stdout;
+        __logger.file_size = 0;
+    }
+
+    s64 slot_count = 64;
+    while(slot_count * GYO_LOG_SLOT_SIZE < ring_size) slot_count *= 2;
+    __logger.slot_count = slot_count;
+    __logger.slots = (u8*)malloc(slot_count * GYO_LOG_SLOT_SIZE);
+    __logger.sequences = (volatile s64*)malloc(slot_count * sizeof(s64));
+    for(s64 i = 0; i < slot_count; i++) __logger.sequences[i] = i;
+    __logger.enqueue_pos = 0;
+    __logger.dequeue_pos = 0;
+
+    __logger.running = 1;
+    __logger.started = true;
+    __logger.writer = thread_start(_logger_writer, NULL);
+    return true;
+}
+
+// Writes every line still in the ring and stops the writer. Call it when no other thread is logging anymore.
+void logger_stop() {
+    if(!__logger.started) return;
+    atomic_store(&__logger.running, 0);
+    thread_join(&__logger.writer);
+    __logger.started = false;
+    if(__logger.file != stdout && __logger.file != stderr) fclose(__logger.file);
+    __logger.file = NULL;
+    free(__logger.slots);
+    free((void*)__logger.sequences);
+    __logger.slots = NULL;
+    __logger.sequences = NULL;
+}
+
+// lines below this level are ignored (but their inputs are still evaluated, use GYO_LOG_MIN_LEVEL to remove them entirely)
+void logger_set_min_level(LogLevel level) { __logger.min_level = level; }
+
+// when the file reaches max_file_size bytes it's renamed to <filename>.1 (and so on up to max_files old files) and a new one is started
+void logger_set_rotation(s64 max_file_size, s32 max_files) {
+    __logger.max_file_size = max_file_size;
+    __logger.max_files = max_files;
+}
+
+// true (default): the calling thread copies the inputs, the writer thread formats them.
+// false: the calling thread formats the line and writes it, slower but pointers in the inputs don't need to stay valid.
+void logger_set_deferred_format(bool deferred) { __logger.immediate_format = !deferred; }
@@ -8,6 +8,8 @@ Mostly performance counter related functions.
 - read_os_timer() to get the current os timer clock cycle
 - estimate_cpu_frequency() to estimate the cpu rdtsc timer frequency.
 - read_cpu_timer() to get the current cpu timer clock cycle (rdtsc is faster than os timers)
+- read_hw_counters() to get the hardware counters of the current thread (instructions, cache misses, branch misses...)
+- hw_counters_close() to close them before the thread exits (they're closed when it does)
 */
 
 #if _WIN32
@@ -38,7 +40,9 @@ inline u64 read_cpu_timer() {
 #else
 
 #ifndef DISABLE_INCLUDES
+    #if defined(__x86_64__) || defined(__i386__)
 	#include <x86intrin.h>
+    #endif
 	#include <sys/time.h>
 #endif
 
@@ -55,7 +59,11 @@ static u64 read_os_timer() {
 }
 
 inline u64 read_cpu_timer() {
-    return 0; //TODO(cogno): rdtsc on arm? I don't know which one to use
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return read_os_timer(); // slower than a cycle counter, but it counts
+#endif
 }
 #endif
 
@@ -81,3 +89,156 @@ u64 estimate_cpu_frequency(int ms_to_wait = 1) {
     u64 freq_estimate = (cpu_counter_end - cpu_counter_start) * os_timer_freq / os_clocks_elapsed;
     return freq_estimate;
 }
+
+//
+// hardware counters (Linux perf_event_open), to know WHY something is slow: how many instructions per cycle,
+// how many cache and branch misses. Every thread reading them gets its own group of counters (opened the first time),
+// all read together with a single syscall. Reading costs ~1us, so use them around blocks much bigger than that.
+// Where they're not available (not Linux, no permission, some VMs) hw_counters_available() is false and they read as 0.
+// With #define HW_COUNTERS 1 the profiler (profiling_v1.h) and the benchmarks (simple_benchmark.h) report them too.
+//
+
+#ifndef HW_COUNTERS
+    #define HW_COUNTERS 0
+#endif
+
+enum HwCounter {
+    HW_CYCLES,        // real core cycles (rdtsc counts at a fixed frequency instead)
+    HW_INSTRUCTIONS,
+    HW_CACHE_MISSES,
+    HW_BRANCH_MISSES,
+    HW_LLC_LOADS,     // reads reaching the last level cache
+    HW_COUNTERS_AMT
+};
+
+const char* HW_COUNTER_NAMES[HW_COUNTERS_AMT] = { "cycles", "instructions", "cache misses", "branch misses", "LLC loads" };
+
+struct HwCounters {
+    u64 values[HW_COUNTERS_AMT];
+};
+
+inline HwCounters hw_counters_diff(HwCounters end, HwCounters start) {
+    HwCounters out;
+    for(int i = 0; i < HW_COUNTERS_AMT; i++) out.values[i] = end.values[i] - start.values[i];
+    return out;
+}
+
+// adds what happened from start to end into total
+inline void hw_counters_accumulate(HwCounters* total, HwCounters start, HwCounters end) {
+    for(int i = 0; i < HW_COUNTERS_AMT; i++) total->values[i] += end.values[i] - start.values[i];
+}
+
+#if defined(__linux__)
+
+#ifndef DISABLE_INCLUDES
+    #include <linux/perf_event.h>
+    #include <sys/syscall.h>
+    #include <sys/ioctl.h>
+    #include <unistd.h>
+#endif
+
+struct _HwCounterGroup {
+    bool initialized;
+    bool available;
+    int leader;
+    int opened_count;
+    int opened[HW_COUNTERS_AMT]; // which HwCounter each member of the group is (some might not be supported)
+    int fds[HW_COUNTERS_AMT];    // the file of each member, fds[0] is the leader
+    ~_HwCounterGroup();
+};
+
+thread_local _HwCounterGroup _hw_counters = {};
+
+int _hw_counter_open(HwCounter counter, int group) {
+    perf_event_attr attr = {};
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    switch(counter) {
+        case HW_CYCLES:        attr.config = PERF_COUNT_HW_CPU_CYCLES; break;
+        case HW_INSTRUCTIONS:  attr.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+        case HW_CACHE_MISSES:  attr.config = PERF_COUNT_HW_CACHE_MISSES; break;
+        case HW_BRANCH_MISSES: attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+        case HW_LLC_LOADS:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_ACCESS << 16);
+            break;
+        default: return -1;
+    }
+    attr.disabled = group == -1; // the leader starts disabled, then we enable the whole group at once
+    attr.exclude_kernel = 1;     // allowed without root on most systems
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group, 0); // this thread, any cpu
+}
+
+_HwCounterGroup* _hw_counters_init() {
+    _HwCounterGroup* g = &_hw_counters;
+    if(g->initialized) return g;
+    g->initialized = true;
+    g->leader = _hw_counter_open(HW_CYCLES, -1);
+    if(g->leader < 0) return g;
+    g->fds[g->opened_count] = g->leader;
+    g->opened[g->opened_count++] = HW_CYCLES;
+    for(int i = HW_CYCLES + 1; i < HW_COUNTERS_AMT; i++) {
+        int fd = _hw_counter_open((HwCounter)i, g->leader);
+        if(fd < 0) continue;
+        g->fds[g->opened_count] = fd;
+        g->opened[g->opened_count++] = i;
+    }
+    ioctl(g->leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(g->leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    g->available = true;
+    return g;
+}
+
+void _hw_counters_close(_HwCounterGroup* g) {
+    for(int i = 0; i < g->opened_count; i++) close(g->fds[i]);
+    g->opened_count = 0;
+    g->available = false;
+    g->initialized = false; // the next read opens them again
+}
+
+_HwCounterGroup::~_HwCounterGroup() { _hw_counters_close(this); }
+
+// true if the counters can be read on this thread
+bool hw_counters_available() { return _hw_counters_init()->available; }
+
+// closes the counters of the current thread, they're also closed when the thread exits.
+// Reading them again opens them again (and starts from 0)
+void hw_counters_close() { _hw_counters_close(&_hw_counters); }
+
+// the counters of the current thread since they were opened, only the difference between 2 reads is meaningful
+HwCounters read_hw_counters() {
+    HwCounters out = {};
+    _HwCounterGroup* g = _hw_counters_init();
+    if(!g->available) return out;
+    u64 data[3 + HW_COUNTERS_AMT]; // count, time enabled, time running, values
+    if(read(g->leader, data, sizeof(data)) <= 0) return out;
+    // when there are more counters than the cpu can count at once the kernel takes turns, so we scale them
+    f64 scale = data[2] > 0 && data[2] < data[1] ? (f64)data[1] / data[2] : 1.0;
+    for(u64 i = 0; i < data[0] && i < HW_COUNTERS_AMT; i++) {
+        out.values[g->opened[i]] = scale == 1.0 ? data[3 + i] : (u64)(data[3 + i] * scale);
+    }
+    return out;
+}
+
+#else
+
+// only Linux is supported, elsewhere the counters read as 0
+bool hw_counters_available() { return false; }
+HwCounters read_hw_counters() { return {}; }
+void hw_counters_close() {}
+
+#endif
+
+// prints instructions per cycle and the misses per call
+void print_hw_counters(HwCounters counters, u64 calls) {
+    if(!hw_counters_available()) { printsl("hardware counters not available"); return; }
+    if(calls == 0) calls = 1;
+    f64 ipc = counters.values[HW_CYCLES] > 0 ? (f64)counters.values[HW_INSTRUCTIONS] / counters.values[HW_CYCLES] : 0;
+    char text[256];
+    snprintf(text, sizeof(text), "IPC=%.2f, per call: instructions=%.1f, cache misses=%.2f, branch misses=%.2f, LLC loads=%.2f", ipc,
+             (f64)counters.values[HW_INSTRUCTIONS] / calls, (f64)counters.values[HW_CACHE_MISSES] / calls,
+             (f64)counters.values[HW_BRANCH_MISSES] / calls, (f64)counters.values[HW_LLC_LOADS] / calls);
+    printsl("%", (const char*)text);
+}
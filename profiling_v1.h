@@ -1,7 +1,7 @@
 #pragma once
 
 /*
-In this file: Basic profile functionality for nested/recursive functions
+In this file: Basic profile functionality for nested/recursive functions, from one or more threads
 */
 
 /*
@@ -10,9 +10,48 @@ USAGE:
 - call begin_profile() when you want to start profiling
 - call end_and_print_profile() when you want to get profiling information
 - add TIME_FUNC or TIME_BLOCK("name") to every block you want to profile
+- use TIME_BANDWIDTH("name", bytes) instead for blocks processing some data (parsing, copies, I/O...),
+  the report will also show how many GB/s (10^9 bytes per second) they go through
 
 This simple profiling can handle functions both nested and recursive.
 It has a limit of 4096 timed blocks.
+
+It works with multiple threads too: each thread has its own table of anchors (created the first time it times a block),
+so threads never touch each other's timings. end_and_print_profile() prints the totals of all threads merged together
+and, if more than one thread was profiled, the breakdown of each thread (call profile_set_thread_name("name") to recognize them).
+With many threads working at the same time, the merged times can be more than the total time (they're summed across threads).
+Call it when the other threads are done (or not profiling anything), their tables are read without locks.
+If you want the numbers instead of the printout, use profile_merge_anchors() and profile_get_thread(index).
+
+With #define HW_COUNTERS 1 (before including performance_counter.h) every block also reads the hardware counters
+(see read_hw_counters) and the report shows the instructions per cycle and the cache/branch misses per hit of each block
+(exclusive, like total). Reading them is a syscall, so it only makes sense for blocks taking more than a few microseconds.
+
+Besides the flat totals, every thread also records the call tree: each block gets a node for each different path
+it's reached from (main -> update -> physics is a different node than main -> render -> physics), so the report
+also shows where inside a function the time goes, with the percentage of the parent it takes.
+Recursion is collapsed: if a block is already in the current path (a -> b -> a) we keep using its node,
+so the tree doesn't grow with the recursion depth and the time isn't counted twice.
+The call tree has a limit of PROFILE_MAX_NODES nodes per thread, after that the time of new paths goes to their parent.
+profile_print_folded(file) writes the tree as folded stacks ("main;update;physics 12345"), the format used by
+flamegraph.pl, speedscope and most flame graph tools.
+
+Totals hide WHEN things happen (a single slow frame, threads waiting for each other), for that there's a tracing mode:
+#define PROFILING_V1_TRACE 1 before including this file and every block also records when it starts and ends
+in a ring buffer of its thread (the last PROFILE_TRACE_EVENTS events of each thread are kept).
+profile_save_chrome_trace("trace.json") then writes them in the Chrome Trace Event format, open it with
+ui.perfetto.dev or chrome://tracing to see the timeline of every thread.
+
+Timing blocks only tells you about the blocks, and each one costs a bit. For something you can leave on all the time
+there's a sampling mode: #define PROFILING_V1_SAMPLING 1 before including this file, then call profile_start_sampling().
+Every interval (1ms by default, the os might round it up to its scheduler tick) of cpu time the thread that's running
+is interrupted (SIGPROF) and we count a sample on the node of the call tree it's in, which is the whole stack of blocks
+open at that moment. The blocks don't get any slower, the cost is just the signal. end_and_print_profile() then also shows, for each block, how many samples landed
+directly inside it (self) and inside it or its children (total), and profile_print_folded(file, false, true)
+writes the samples as folded stacks. Blocks still have to be marked with TIME_BLOCK/TIME_FUNC, code outside of them is
+counted as "outside any block". The numbers are statistical, you need many samples (seconds of run time) to trust them.
+Windows has no signals, there a thread wakes up every interval (at least 1ms) and samples every profiled thread,
+so threads which are sleeping or waiting are counted too (it measures wall time instead of cpu time).
 */
 
 //TODO(cogno): TEST THIS, expecially in:
@@ -26,6 +65,14 @@ It has a limit of 4096 timed blocks.
     #define PROFILING_V1 1
 #endif
 
+#ifndef PROFILING_V1_TRACE
+    #define PROFILING_V1_TRACE 0
+#endif
+
+#ifndef PROFILING_V1_SAMPLING
+    #define PROFILING_V1_SAMPLING 0
+#endif
+
 #if PROFILING_V1
 
 #ifndef GYOFIRST
@@ -34,54 +81,271 @@ It has a limit of 4096 timed blocks.
 #ifndef GYOPERFORMANCE_COUNTER
     #include "performance_counter.h"
 #endif
+#ifndef GYO_THREADS
+    #include "threads.h"
+#endif
+
+#if PROFILING_V1_SAMPLING && !defined(_WIN32) && !defined(DISABLE_INCLUDES)
+    #include <signal.h>   // for sigaction
+    #include <sys/time.h> // for setitimer
+#endif
 
-//API(cogno): we can very easily save the index of the parent to have better ui, but it costs more, is it worth it?
 struct TimeAnchor {
     u64 elapsed_exclusive;
     u64 elapsed_inclusive;
     u64 hit_count;
+    u64 processed_bytes; // by TIME_BANDWIDTH blocks, divided by elapsed_inclusive for the throughput
     const char* label;
+#if HW_COUNTERS
+    HwCounters hw; // exclusive, like elapsed_exclusive
+#endif
 };
 
 #define ANCHORS_AMT 4096
-TimeAnchor _anchors[ANCHORS_AMT] = {};
-int _current_parent_index = 0;
+#define PROFILE_MAX_NODES 8192
+#define PROFILE_TRACE_EVENTS 65536 // per thread, must be a power of 2
+
+// a block in the call tree, reached from a specific path
+struct ProfileNode {
+    u64 elapsed_exclusive;
+    u64 elapsed_inclusive;
+    u64 hit_count;
+    int anchor;       // which block it is (index in the anchors), 0 is the root
+    int parent;       // the indices of the other nodes, 0 means none (the root can't be anyone's child or sibling)
+    int first_child;
+    int next_sibling;
+#if PROFILING_V1_SAMPLING
+    u64 samples;      // taken while this was the innermost open block
+#endif
+};
+
+#define PROFILE_TRACE_BEGIN 0
+#define PROFILE_TRACE_END 1
+
+struct ProfileTraceEvent {
+    u64 timestamp; // cpu timer
+    u32 anchor;
+    u32 type;      // PROFILE_TRACE_BEGIN or PROFILE_TRACE_END
+};
+
+// the anchors of a single thread, threads are added to a list the first time they time something and never removed
+// (so the timings of threads which already finished are still reported)
+struct ProfileThread {
+    TimeAnchor anchors[ANCHORS_AMT];
+    int current_parent_index;
+    ProfileNode nodes[PROFILE_MAX_NODES]; // nodes[0] is the root
+    int node_count;
+    int current_node;
+    int thread_index; // in the order they started profiling, the first one is 0
+    const char* name;
+    ProfileThread* next;
+#if PROFILING_V1_TRACE
+    ProfileTraceEvent trace[PROFILE_TRACE_EVENTS]; // ring buffer, only the owner thread writes it
+    u64 trace_count; // how many events were ever written, the oldest get overwritten
+#endif
+};
+
+#if PROFILING_V1_TRACE
+inline void _profile_trace(ProfileThread* t, u64 timestamp, int anchor, u32 type) {
+    ProfileTraceEvent* e = &t->trace[t->trace_count++ & (PROFILE_TRACE_EVENTS - 1)];
+    e->timestamp = timestamp;
+    e->anchor = anchor;
+    e->type = type;
+}
+#endif
+
+volatile s64 _profile_threads = 0; // ProfileThread*, the last one added
+volatile s32 _profile_thread_count = 0;
+thread_local ProfileThread* _profile_current_thread = NULL;
 u64 _profile_start = 0;
 u64 _profile_end = 0;
 
+ProfileThread* _profile_register_thread() {
+    ProfileThread* t = (ProfileThread*)calloc(1, sizeof(ProfileThread));
+    ASSERT_ALWAYS(t != NULL, "OUT OF MEMORY! couldn't allocate the profiling anchors of a thread");
+    t->thread_index = atomic_add(&_profile_thread_count, 1);
+    t->node_count = 1; // the root
+    // lock free push on the list
+    s64 head;
+    do {
+        head = atomic_load(&_profile_threads);
+        t->next = (ProfileThread*)head;
+    } while(atomic_compare_exchange(&_profile_threads, head, (s64)t) != head);
+    _profile_current_thread = t;
+    return t;
+}
+
+inline ProfileThread* _profile_get_current_thread() {
+    ProfileThread* t = _profile_current_thread;
+    if(t == NULL) t = _profile_register_thread();
+    return t;
+}
+
+// the name shown for the current thread in the per-thread breakdown
+void profile_set_thread_name(const char* name) { _profile_get_current_thread()->name = name; }
+
+int profile_thread_count() { return atomic_load(&_profile_thread_count); }
+
+// the anchors of the index-th thread that started profiling, NULL if there's no such thread
+ProfileThread* profile_get_thread(int index) {
+    for(ProfileThread* t = (ProfileThread*)atomic_load(&_profile_threads); t != NULL; t = t->next) {
+        if(t->thread_index == index) return t;
+    }
+    return NULL;
+}
+
+// the timings of every thread summed together, out must have space for ANCHORS_AMT anchors
+void profile_merge_anchors(TimeAnchor* out) {
+    memset(out, 0, ANCHORS_AMT * sizeof(TimeAnchor));
+    for(ProfileThread* t = (ProfileThread*)atomic_load(&_profile_threads); t != NULL; t = t->next) {
+        for(int i = 0; i < ANCHORS_AMT; i++) {
+            TimeAnchor a = t->anchors[i];
+            if(a.label == nullptr) continue;
+            out[i].elapsed_exclusive += a.elapsed_exclusive;
+            out[i].elapsed_inclusive += a.elapsed_inclusive;
+            out[i].hit_count += a.hit_count;
+            out[i].processed_bytes += a.processed_bytes;
+            out[i].label = a.label;
+#if HW_COUNTERS
+            for(int c = 0; c < HW_COUNTERS_AMT; c++) out[i].hw.values[c] += a.hw.values[c];
+#endif
+        }
+    }
+}
+
+// the child of parent for the given block, created if it's the first time we reach it from there
+int _profile_find_or_add_child(ProfileThread* t, int parent, int anchor) {
+    int last = 0;
+    for(int c = t->nodes[parent].first_child; c != 0; c = t->nodes[c].next_sibling) {
+        if(t->nodes[c].anchor == anchor) return c;
+        last = c;
+    }
+    if(t->node_count >= PROFILE_MAX_NODES) return parent; // full, the time goes to the parent
+    int c = t->node_count++;
+    ProfileNode* node = &t->nodes[c];
+    node->anchor = anchor;
+    node->parent = parent;
+    // appended at the end, so children are in the order they're first called
+    if(last == 0) t->nodes[parent].first_child = c;
+    else t->nodes[last].next_sibling = c;
+    return c;
+}
+
+inline int _profile_enter_node(ProfileThread* t, int anchor) {
+    // recursion, we're already inside this block so we keep using its node
+    for(int n = t->current_node; n != 0; n = t->nodes[n].parent) {
+        if(t->nodes[n].anchor == anchor) return n;
+    }
+    return _profile_find_or_add_child(t, t->current_node, anchor);
+}
+
+void _profile_merge_nodes(ProfileThread* out, int out_node, ProfileThread* t, int node) {
+    for(int c = t->nodes[node].first_child; c != 0; c = t->nodes[c].next_sibling) {
+        ProfileNode* src = &t->nodes[c];
+        int merged = _profile_find_or_add_child(out, out_node, src->anchor);
+        if(merged == out_node) continue; // full
+        out->nodes[merged].elapsed_exclusive += src->elapsed_exclusive;
+        out->nodes[merged].elapsed_inclusive += src->elapsed_inclusive;
+        out->nodes[merged].hit_count += src->hit_count;
+#if PROFILING_V1_SAMPLING
+        out->nodes[merged].samples += src->samples;
+#endif
+        _profile_merge_nodes(out, merged, t, c);
+    }
+}
+
+// the anchors and call trees of every thread summed together into out (which should be zeroed)
+void profile_merge(ProfileThread* out) {
+    profile_merge_anchors(out->anchors);
+    out->node_count = 1;
+    for(int i = 0; i < profile_thread_count(); i++) { // in order, so the first thread's paths come first
+        ProfileThread* t = profile_get_thread(i);
+        if(t == NULL) continue;
+#if PROFILING_V1_SAMPLING
+        out->nodes[0].samples += t->nodes[0].samples;
+#endif
+        _profile_merge_nodes(out, 0, t, 0);
+    }
+}
+
 
 struct time_block {
     time_block(int counter, const char* func_name) {
-        this->_parent = _current_parent_index;
+        this->_thread = _profile_get_current_thread();
+        TimeAnchor* anchors = this->_thread->anchors;
+        this->_parent = this->_thread->current_parent_index;
         this->_current = counter;
         this->_label = func_name;
-        this->_old_elapsed_at_root = _anchors[counter].elapsed_inclusive;
+        this->_old_elapsed_at_root = anchors[counter].elapsed_inclusive;
+        
+        this->_parent_node = this->_thread->current_node;
+        this->_node = _profile_enter_node(this->_thread, counter);
+        this->_old_node_elapsed_at_root = this->_thread->nodes[this->_node].elapsed_inclusive;
         
-        _current_parent_index = counter;
+        this->_thread->current_parent_index = counter;
+        this->_thread->current_node = this->_node;
+#if HW_COUNTERS
+        this->_hw_start = read_hw_counters();
+#endif
         this->_start = read_cpu_timer();
+#if PROFILING_V1_TRACE
+        anchors[counter].label = func_name; // the block might still be running when the trace is saved
+        _profile_trace(this->_thread, this->_start, counter, PROFILE_TRACE_BEGIN);
+#endif
+    }
+    
+    time_block(int counter, const char* func_name, u64 processed_bytes) : time_block(counter, func_name) {
+        this->_thread->anchors[counter].processed_bytes += processed_bytes;
     }
     
     ~time_block() {
-        u64 total = read_cpu_timer() - this->_start;
-        _current_parent_index = this->_parent;
+        u64 end = read_cpu_timer();
+        u64 total = end - this->_start;
+#if PROFILING_V1_TRACE
+        _profile_trace(this->_thread, end, this->_current, PROFILE_TRACE_END);
+#endif
+#if HW_COUNTERS
+        HwCounters hw = hw_counters_diff(read_hw_counters(), this->_hw_start);
+        for(int c = 0; c < HW_COUNTERS_AMT; c++) {
+            this->_thread->anchors[this->_parent ].hw.values[c] -= hw.values[c];
+            this->_thread->anchors[this->_current].hw.values[c] += hw.values[c];
+        }
+#endif
+        TimeAnchor* anchors = this->_thread->anchors;
+        this->_thread->current_parent_index = this->_parent;
+        
+        anchors[this->_parent ].elapsed_exclusive -= total;
+        anchors[this->_current].elapsed_exclusive += total;
+        anchors[this->_current].elapsed_inclusive = this->_old_elapsed_at_root + total;
+        anchors[this->_current].hit_count++;
         
-        _anchors[this->_parent ].elapsed_exclusive -= total;
-        _anchors[this->_current].elapsed_exclusive += total;
-        _anchors[this->_current].elapsed_inclusive = this->_old_elapsed_at_root + total;
-        _anchors[this->_current].hit_count++;
+        anchors[this->_current].label = this->_label; // yes I know, it gets replaced multiple times, I hate C++
         
-        _anchors[this->_current].label = this->_label; // yes I know, it gets replaced multiple times, I hate C++
+        ProfileNode* nodes = this->_thread->nodes;
+        this->_thread->current_node = this->_parent_node;
+        nodes[this->_parent_node].elapsed_exclusive -= total;
+        nodes[this->_node       ].elapsed_exclusive += total;
+        nodes[this->_node       ].elapsed_inclusive = this->_old_node_elapsed_at_root + total;
+        nodes[this->_node       ].hit_count++;
     }
     
+    ProfileThread* _thread; // the anchors of the thread we're in
     const char* _label;
     u64 _start = 0;
     int _current = 0; //save them so we can keep them (inner blocks edit global ones)
     int _parent = 0;  //save them so we can keep them (inner blocks edit global ones)
     u64 _old_elapsed_at_root = 0;
+    int _node = 0;        // same as above, but for the call tree
+    int _parent_node = 0;
+    u64 _old_node_elapsed_at_root = 0;
+#if HW_COUNTERS
+    HwCounters _hw_start;
+#endif
 };
 
 #define TIME_FUNC time_block STRING_JOIN(t_, __LINE__)(__COUNTER__ + 1, __FUNCTION__)
 #define TIME_BLOCK(name) time_block STRING_JOIN(t_, __LINE__)(__COUNTER__ + 1, name)
+#define TIME_BANDWIDTH(name, bytes) time_block STRING_JOIN(t_, __LINE__)(__COUNTER__ + 1, name, bytes)
 #define END_OF_COMPILATION_UNIT static_assert(__COUNTER__ < ANCHORS_AMT, "Number of profile points exceeds size of profiler::Anchors array")
 
 void begin_profile() {
@@ -102,18 +366,15 @@ inline u8 count_digits(u64 x){
 }
 #endif
 
-void end_and_print_profile() {
+void _print_anchors(TimeAnchor* anchors, u64 total_elapsed, u64 cpu_frequency) {
     // Todo(Quattro) use print instead of printf
-    _profile_end = read_cpu_timer();
-    u64 total_elapsed = _profile_end - _profile_start;
-    
     //calculate lengths of texts for vertical formatting
     int max_label_len = 0;
     u8 max_time_length = 0;
     u8 max_incl_time_length = 0;
     bool one_has_childrens = false;
     for(int i = 0; i < ANCHORS_AMT; i++) {
-        TimeAnchor t = _anchors[i];
+        TimeAnchor t = anchors[i];
         if(t.label == nullptr) continue;
         
         int label_len = 0;
@@ -131,7 +392,7 @@ void end_and_print_profile() {
     
     // PERF(cogno): can be optimized for printing speed, no need for now since it's a report tool which prints once at the end of the whole program
     for(int i = 0; i < ANCHORS_AMT; i++) {
-        TimeAnchor t = _anchors[i];
+        TimeAnchor t = anchors[i];
         if (t.label == nullptr) continue;
         
         float percentage_exclusive     = 100.0f * t.elapsed_exclusive / total_elapsed;
@@ -180,21 +441,333 @@ void end_and_print_profile() {
             printf("hit %lld time", t.hit_count);
             if(t.hit_count > 1) putchar('s');
         }
+        
+        //throughput, over the inclusive time (the bytes are processed by the children too)
+        if(t.processed_bytes > 0 && t.elapsed_inclusive > 0) {
+            f64 seconds = (f64)t.elapsed_inclusive / cpu_frequency;
+            printf(" | %.3f GB/s (%llu bytes)", t.processed_bytes / seconds / 1000000000.0, (unsigned long long)t.processed_bytes);
+        }
+#if HW_COUNTERS
+        if(hw_counters_available()) {
+            // exclusive, like total
+            u64 cycles = t.hw.values[HW_CYCLES];
+            f64 hits = t.hit_count > 0 ? (f64)t.hit_count : 1.0;
+            printf(" | IPC=%.2f, per hit: cache misses=%.2f, branch misses=%.2f, LLC loads=%.2f",
+                   cycles > 0 ? (f64)t.hw.values[HW_INSTRUCTIONS] / cycles : 0.0, t.hw.values[HW_CACHE_MISSES] / hits,
+                   t.hw.values[HW_BRANCH_MISSES] / hits, t.hw.values[HW_LLC_LOADS] / hits);
+        }
+#endif
         putchar('\n');
     }
     
     //TODO(cogno): print total cycles/seconds from start to end?
 }
 
+void _print_tree_label_width(ProfileThread* t, int node, int depth, int* width) {
+    for(int c = t->nodes[node].first_child; c != 0; c = t->nodes[c].next_sibling) {
+        const char* label = t->anchors[t->nodes[c].anchor].label;
+        int label_len = depth * 2 + (int)strlen(label);
+        if(label_len > *width) *width = label_len;
+        _print_tree_label_width(t, c, depth + 1, width);
+    }
+}
+
+void _print_tree_node(ProfileThread* t, int node, int depth, u64 parent_elapsed, u64 total_elapsed, int label_width) {
+    for(int c = t->nodes[node].first_child; c != 0; c = t->nodes[c].next_sibling) {
+        ProfileNode n = t->nodes[c];
+        const char* label = t->anchors[n.anchor].label;
+        pad_right(depth * 2);
+        printf("%s", label);
+        pad_right(label_width - depth * 2 - (int)strlen(label));
+        printf(" : incl=%lld (%6.2f%%, %6.2f%% of parent), excl=%lld (%6.2f%%), ",
+               (long long)n.elapsed_inclusive, 100.0f * n.elapsed_inclusive / total_elapsed, parent_elapsed == 0 ? 0.0f : 100.0f * n.elapsed_inclusive / parent_elapsed,
+               (long long)n.elapsed_exclusive, 100.0f * n.elapsed_exclusive / total_elapsed);
+        if(n.hit_count == 1) printf("hit once\n");
+        else printf("hit %lld times\n", (long long)n.hit_count);
+        _print_tree_node(t, c, depth + 1, n.elapsed_inclusive, total_elapsed, label_width);
+    }
+}
+
+// prints the call tree of a thread (or of profile_merge), children indented under their parent
+void print_profile_tree(ProfileThread* t, u64 total_elapsed) {
+    int label_width = 0;
+    _print_tree_label_width(t, 0, 0, &label_width);
+    _print_tree_node(t, 0, 0, total_elapsed, total_elapsed, label_width);
+}
+
+void _print_folded_node(FILE* file, ProfileThread* t, int node, char* stack, int stack_size, bool samples) {
+    for(int c = t->nodes[node].first_child; c != 0; c = t->nodes[c].next_sibling) {
+        ProfileNode n = t->nodes[c];
+        // stack + ";" + label, a ';' inside the label would be taken as a separator, so it becomes ':'
+        int size = stack_size;
+        if(size > 0 && size < 4095) stack[size++] = ';';
+        for(const char* l = t->anchors[n.anchor].label; *l != 0 && size < 4095; l++) stack[size++] = *l == ';' ? ':' : *l;
+        stack[size] = 0;
+        s64 value = (s64)n.elapsed_exclusive;
+#if PROFILING_V1_SAMPLING
+        if(samples) value = (s64)n.samples;
+#endif
+        if(value > 0) fprintf(file, "%s %lld\n", stack, (long long)value);
+        _print_folded_node(file, t, c, stack, size, samples);
+    }
+}
+
+// writes the call tree as folded stacks, one line for each path with its exclusive cycles, ready for flame graph tools
+// (e.g. flamegraph.pl out.folded > out.svg). With per_thread each line starts with the thread it comes from.
+// With samples (and PROFILING_V1_SAMPLING) each line has how many samples were taken there instead of the cycles.
+void profile_print_folded(FILE* file, bool per_thread = false, bool samples = false) {
+    char stack[4096];
+    if(!per_thread) {
+        ProfileThread* merged = (ProfileThread*)calloc(1, sizeof(ProfileThread)); // too big for the stack
+        profile_merge(merged);
+        _print_folded_node(file, merged, 0, stack, 0, samples);
+        free(merged);
+        return;
+    }
+    for(int i = 0; i < profile_thread_count(); i++) {
+        ProfileThread* t = profile_get_thread(i);
+        if(t == NULL) continue;
+        int size = t->name != NULL ? snprintf(stack, sizeof(stack), "%s", t->name) : snprintf(stack, sizeof(stack), "thread %d", t->thread_index);
+        _print_folded_node(file, t, 0, stack, size < 4095 ? size : 4095, samples);
+    }
+}
+
+void _profile_write_json_string(FILE* file, const char* s) {
+    fputc('"', file);
+    for(; *s != 0; s++) {
+        if(*s == '"' || *s == '\\') fputc('\\', file);
+        if((u8)*s < 0x20) fputc(' ', file);
+        else fputc(*s, file);
+    }
+    fputc('"', file);
+}
+
+// writes the traced events in the Chrome Trace Event format (JSON), without PROFILING_V1_TRACE the trace is empty.
+// Events from before begin_profile() are skipped, as are the ends whose beginning was overwritten in the ring buffer.
+void profile_write_chrome_trace(FILE* file) {
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"profile\"}}");
+#if PROFILING_V1_TRACE
+    f64 cycles_per_us = estimate_cpu_frequency(10) / 1000000.0;
+    for(int i = 0; i < profile_thread_count(); i++) {
+        ProfileThread* t = profile_get_thread(i);
+        if(t == NULL) continue;
+        fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", i);
+        if(t->name != NULL) _profile_write_json_string(file, t->name);
+        else fprintf(file, "\"thread %d\"", i);
+        fprintf(file, "}}");
+        
+        u64 count = t->trace_count;
+        u64 first = count > PROFILE_TRACE_EVENTS ? count - PROFILE_TRACE_EVENTS : 0;
+        int depth = 0;
+        for(u64 e = first; e < count; e++) {
+            ProfileTraceEvent event = t->trace[e & (PROFILE_TRACE_EVENTS - 1)];
+            if(event.timestamp < _profile_start) continue;
+            if(event.type == PROFILE_TRACE_END && depth == 0) continue; // we don't have its beginning
+            depth += event.type == PROFILE_TRACE_BEGIN ? 1 : -1;
+            f64 us = (event.timestamp - _profile_start) / cycles_per_us;
+            if(event.type == PROFILE_TRACE_BEGIN) {
+                const char* label = t->anchors[event.anchor].label;
+                fprintf(file, ",\n{\"name\":");
+                _profile_write_json_string(file, label != nullptr ? label : "?");
+                fprintf(file, ",\"ph\":\"B\",\"ts\":%.3f,\"pid\":1,\"tid\":%d}", us, i);
+            } else {
+                fprintf(file, ",\n{\"ph\":\"E\",\"ts\":%.3f,\"pid\":1,\"tid\":%d}", us, i);
+            }
+        }
+    }
+#endif
+    fprintf(file, "\n]}\n");
+}
+
+// same as profile_write_chrome_trace, to a new file. Returns false if the file couldn't be created.
+bool profile_save_chrome_trace(const char* path) {
+    FILE* file = fopen(path, "wb");
+    if(file == NULL) return false;
+    profile_write_chrome_trace(file);
+    fclose(file);
+    return true;
+}
+
+#if PROFILING_V1_SAMPLING
+volatile s32 _profile_sampling = 0;
+volatile s64 _profile_samples_untracked = 0; // taken on threads which never timed a block
+s32 _profile_sample_interval_us = 0;
+
+#ifdef _WIN32
+Thread _profile_sampler = {};
+
+// no signals on windows, we look at every thread from the outside
+void _profile_sampler_loop(void*) {
+    s32 interval_ms = _profile_sample_interval_us / 1000 > 0 ? _profile_sample_interval_us / 1000 : 1;
+    while(atomic_load(&_profile_sampling)) {
+        thread_sleep_ms(interval_ms);
+        for(ProfileThread* t = (ProfileThread*)atomic_load(&_profile_threads); t != NULL; t = t->next) {
+            int node = *(volatile int*)&t->current_node;
+            t->nodes[node].samples++; // only this thread writes the samples
+        }
+    }
+}
+#else
+struct sigaction _profile_old_sigprof;
+
+// runs on the interrupted thread, so it can only touch that thread's table (and nothing that locks or allocates)
+void _profile_sample_handler(int) {
+    ProfileThread* t = _profile_current_thread;
+    if(t == NULL) {
+        atomic_add(&_profile_samples_untracked, 1);
+        return;
+    }
+    // the current node is the whole stack of open blocks, blocks only change it after their node is ready
+    int node = *(volatile int*)&t->current_node;
+    t->nodes[node].samples++; // SIGPROF is blocked while we're here, so nobody else is writing it
+}
+#endif
+
+// starts taking a sample every interval_us microseconds of cpu time (see the top of the file).
+// Returns false if it's already running or the timer couldn't be started.
+bool profile_start_sampling(s32 interval_us = 1000) {
+    if(atomic_compare_exchange(&_profile_sampling, 0, 1) != 0) return false;
+    _profile_sample_interval_us = interval_us > 0 ? interval_us : 1;
+#ifdef _WIN32
+    _profile_sampler = thread_start(_profile_sampler_loop, NULL);
+    return true;
+#else
+    struct sigaction action = {};
+    action.sa_handler = _profile_sample_handler;
+    action.sa_flags = SA_RESTART; // the syscalls we interrupt continue instead of failing with EINTR
+    sigemptyset(&action.sa_mask);
+    struct itimerval timer = {};
+    timer.it_interval.tv_sec = _profile_sample_interval_us / 1000000;
+    timer.it_interval.tv_usec = _profile_sample_interval_us % 1000000;
+    timer.it_value = timer.it_interval;
+    if(sigaction(SIGPROF, &action, &_profile_old_sigprof) != 0) {
+        atomic_store(&_profile_sampling, 0);
+        return false;
+    }
+    if(setitimer(ITIMER_PROF, &timer, NULL) != 0) {
+        sigaction(SIGPROF, &_profile_old_sigprof, NULL);
+        atomic_store(&_profile_sampling, 0);
+        return false;
+    }
+    return true;
+#endif
+}
+
+void profile_stop_sampling() {
+    if(!atomic_load(&_profile_sampling)) return;
+#ifdef _WIN32
+    atomic_store(&_profile_sampling, 0);
+    thread_join(&_profile_sampler);
+#else
+    struct itimerval timer = {};
+    setitimer(ITIMER_PROF, &timer, NULL);
+    // a signal already on its way would kill the program with the default action, so we ignore it before going back
+    signal(SIGPROF, SIG_IGN);
+    sigaction(SIGPROF, &_profile_old_sigprof, NULL);
+    atomic_store(&_profile_sampling, 0);
+#endif
+}
+
+// the samples of node and all of its children
+u64 _profile_count_samples(ProfileThread* t, int node, u64* self, u64* total) {
+    u64 inside = t->nodes[node].samples;
+    for(int c = t->nodes[node].first_child; c != 0; c = t->nodes[c].next_sibling) inside += _profile_count_samples(t, c, self, total);
+    int anchor = t->nodes[node].anchor;
+    if(node != 0) {
+        // recursion is collapsed, so a block is never inside itself and it's never counted twice
+        self[anchor] += t->nodes[node].samples;
+        total[anchor] += inside;
+    }
+    return inside;
+}
+
+// for each block how many samples were taken directly inside it (self) and inside it or its children (total),
+// from the most self samples to the least. untracked are the samples of threads without a table (0 for a single thread).
+void print_profile_samples(ProfileThread* t, u64 untracked = 0) {
+    u64* self = (u64*)calloc(2 * ANCHORS_AMT, sizeof(u64));
+    u64* total = self + ANCHORS_AMT;
+    u64 all = _profile_count_samples(t, 0, self, total) + untracked;
+    u64 outside = t->nodes[0].samples + untracked;
+    printf("%llu samples (every %dus of cpu time), %llu (%.2f%%) outside any block\n",
+           (unsigned long long)all, _profile_sample_interval_us, (unsigned long long)outside, all > 0 ? 100.0 * outside / all : 0.0);
+    
+    int order[ANCHORS_AMT];
+    int count = 0;
+    int max_label_len = 0;
+    for(int i = 0; i < ANCHORS_AMT; i++) {
+        if(total[i] == 0 || t->anchors[i].label == nullptr) continue;
+        // insertion sort, there are never many blocks with samples
+        int at = count++;
+        while(at > 0 && self[order[at - 1]] < self[i]) { order[at] = order[at - 1]; at--; }
+        order[at] = i;
+        int label_len = (int)strlen(t->anchors[i].label);
+        if(label_len > max_label_len) max_label_len = label_len;
+    }
+    for(int i = 0; i < count; i++) {
+        int a = order[i];
+        printf("%s", t->anchors[a].label);
+        pad_right(max_label_len - (int)strlen(t->anchors[a].label));
+        printf(" : self=%6.2f%% (%llu), total=%6.2f%% (%llu)\n",
+               100.0 * self[a] / all, (unsigned long long)self[a], 100.0 * total[a] / all, (unsigned long long)total[a]);
+    }
+    free(self);
+}
+#else
+bool profile_start_sampling(s32 = 1000) { return false; }
+void profile_stop_sampling() {}
+#endif
+
+void end_and_print_profile() {
+    _profile_end = read_cpu_timer();
+    u64 total_elapsed = _profile_end - _profile_start;
+    u64 cpu_frequency = estimate_cpu_frequency(10);
+    
+    int thread_count = profile_thread_count();
+    ProfileThread* merged = (ProfileThread*)calloc(1, sizeof(ProfileThread)); // too big for the stack
+    profile_merge(merged);
+    if(thread_count > 1) printf("all %d threads:\n", thread_count);
+    _print_anchors(merged->anchors, total_elapsed, cpu_frequency);
+    printf("\ncall tree:\n");
+    print_profile_tree(merged, total_elapsed);
+#if PROFILING_V1_SAMPLING
+    printf("\nsamples:\n");
+    print_profile_samples(merged, atomic_load(&_profile_samples_untracked));
+#endif
+    free(merged);
+    if(thread_count <= 1) return;
+    
+    for(int i = 0; i < thread_count; i++) {
+        ProfileThread* t = profile_get_thread(i);
+        if(t == NULL) continue;
+        if(t->name != NULL) printf("\nthread %d (%s):\n", i, t->name);
+        else printf("\nthread %d:\n", i);
+        _print_anchors(t->anchors, total_elapsed, cpu_frequency);
+        printf("\ncall tree:\n");
+        print_profile_tree(t, total_elapsed);
+#if PROFILING_V1_SAMPLING
+        printf("\nsamples:\n");
+        print_profile_samples(t);
+#endif
+    }
+}
+
 #else
 
 #define TIME_FUNC
 #define TIME_BLOCK(name)
+#define TIME_BANDWIDTH(name, bytes)
 #define END_OF_COMPILATION_UNIT
 
 
 void begin_profile() {}
 void end_and_print_profile() {}
+void profile_set_thread_name(const char*) {}
+void profile_print_folded(FILE*, bool = false, bool = false) {}
+bool profile_start_sampling(int = 1000) { return false; }
+void profile_stop_sampling() {}
+void profile_write_chrome_trace(FILE*) {}
+bool profile_save_chrome_trace(const char*) { return false; }
 
 
 #endif
@@ -0,0 +1,237 @@
+#pragma once
+#define GYO_SERIALIZE
+
+/*
+In this file:
+- SERIALIZABLE(Type, fields...), to read/write a struct in a compact binary format by just listing its fields
+- serialize_write/serialize_read for every basic type, str, Array and your SERIALIZABLE structs
+- serialize_write_header/serialize_read_header to tag the whole data with a magic and a version
+
+Example:
+struct Player { u32 id; str name; vec3 position; Array<u32> items; s64 score; };
+SERIALIZABLE(Player, id, name, position, items, score)
+
+StrBuilder b = make_str_builder();
+serialize_write_header(&b, "SAVE", 3);
+serialize_write(&b, &player);
+
+StrParser p = make_str_parser(file_content);
+u32 version;
+Player loaded = {};
+if(!serialize_read_header(&p, "SAVE", &version) || !serialize_read(&p, &loaded)) { ...corrupted data... }
+
+Format:
+- unsigned integers are varints, signed ones zigzag varints (so small numbers take 1 byte)
+- f32, f64, bool, u8, s8 and any other trivially copyable type (vec3, your POD structs...) are raw bytes
+- str is a varint size followed by its bytes. Reading is zero-copy: the str points INSIDE the buffer you're reading, so keep it alive
+- Array<T> is a varint count followed by the elements, all copied with a single memcpy if T is trivially copyable (and not SERIALIZABLE)
+- SERIALIZABLE structs are how many fields they have, their size in bytes, and then each field in order
+
+Versioning: each struct saves how many fields it has, so you can ADD new fields at the END of the list.
+Old data read by new code leaves the new fields untouched (so initialize them before reading),
+new data read by old code skips the fields it doesn't know.
+Never remove or reorder fields (renaming them is fine), for bigger changes use the header version and convert by hand.
+A SERIALIZABLE struct used inside another one must be declared before it.
+Reading never crashes on corrupted/truncated data, the read functions just return false.
+*/
+
+#ifndef GYOFIRST
+    #include "first.h"
+#endif
+
+#ifndef GYO_ARRAY
+    #include "array.h"
+#endif
+
+#ifndef GYO_STR
+    #include "str.h"
+#endif
+
+#define SERIALIZABLE(Type, ...) \
+constexpr bool _serialize_is_struct(Type*) { return true; } \
+void serialize_write(StrBuilder* b, Type* value) { \
+    str_builder_append_varint(b, COUNTER(__VA_ARGS__)); \
+    _SerializeSize size = _serialize_begin_size(b); \
+    FOR_EACH(_SERIALIZE_WRITE_FIELD, __VA_ARGS__) \
+    _serialize_end_size(b, size); \
+} \
+bool serialize_read(StrParser* p, Type* value) { \
+    u64 field_count; \
+    StrParser fields; \
+    if(!_serialize_read_struct_header(p, &field_count, &fields)) return false; \
+    u64 fields_read = 0; \
+    FOR_EACH(_SERIALIZE_READ_FIELD, __VA_ARGS__) \
+    return true; \
+}
+
+#define _SERIALIZE_WRITE_FIELD(field) serialize_write(b, &value->field);
+#define _SERIALIZE_READ_FIELD(field) if(fields_read++ < field_count && !serialize_read(&fields, &value->field)) return false;
+
+// the size of a struct is written before its fields, so we leave space for it and fill it at the end
+struct _SerializeSize {
+    u8* chunk_ptr; // chunks never move, so for a chunked StrBuilder we can keep the pointer
+    s32 offset;    // a normal StrBuilder might realloc, so we keep the offset
+    s64 start;
+};
+
+inline _SerializeSize _serialize_begin_size(StrBuilder* b) {
+    str_builder_reserve(b, sizeof(u32)); // also makes sure the 4 bytes are in the same chunk
+    _SerializeSize size = {};
+    size.offset = b->size;
+    size.chunk_ptr = str_builder_is_chunked(b) ? b->ptr + b->size : NULL;
+    b->size += sizeof(u32);
+    size.start = str_builder_total_size(b);
+    return size;
+}
+
+inline void _serialize_end_size(StrBuilder* b, _SerializeSize size) {
+    s64 written = str_builder_total_size(b) - size.start;
+    ASSERT_ALWAYS(written <= MAX_U32, "struct too big to serialize (% bytes)", written);
+    u32 to_write = (u32)written;
+    u8* dest = size.chunk_ptr != NULL ? size.chunk_ptr : b->ptr + size.offset;
+    memcpy(dest, &to_write, sizeof(u32));
+}
+
+bool _serialize_read_struct_header(StrParser* p, u64* field_count, StrParser* fields) {
+    if(!str_parser_get_varint(p, field_count)) return false;
+    if(p->size < (s32)sizeof(u32)) return false;
+    u32 size;
+    memcpy(&size, p->ptr, sizeof(u32)); // might not be aligned
+    str_parser_advance(p, sizeof(u32));
+    if(size > (u32)p->size) return false;
+    *fields = make_str_parser(p->ptr, size);
+    str_parser_advance(p, size); // whatever fields we don't know get skipped
+    return true;
+}
+
+//
+// header
+//
+
+// magic is 4 characters to recognize your data, version is yours to handle changes in the format
+void serialize_write_header(StrBuilder* b, str magic, u32 version) {
+    ASSERT(magic.size == 4, "magic should only be 4 characters long!");
+    str_builder_append(b, magic);
+    str_builder_append_varint(b, version);
+}
+
+bool serialize_read_header(StrParser* p, str magic, u32* out_version) {
+    if(p->size < 4 || !str_parser_check_magic(p, magic)) return false;
+    u64 version;
+    if(!str_parser_get_varint(p, &version) || version > MAX_U32) return false;
+    if(out_version != NULL) *out_version = (u32)version;
+    return true;
+}
+
+//
+// basic types
+//
+
+// anything trivially copyable is written as raw bytes
+template<typename T>
+void serialize_write(StrBuilder* b, T* value) {
+    static_assert(__is_trivially_copyable(T), "this type cannot be serialized as raw bytes, use SERIALIZABLE(Type, fields...) on it");
+    str_builder_append_raw(b, (u8*)value, sizeof(T));
+}
+
+template<typename T>
+bool serialize_read(StrParser* p, T* out) {
+    static_assert(__is_trivially_copyable(T), "this type cannot be serialized as raw bytes, use SERIALIZABLE(Type, fields...) on it");
+    if(p->size < (s32)sizeof(T)) return false;
+    memcpy(out, p->ptr, sizeof(T));
+    str_parser_advance(p, sizeof(T));
+    return true;
+}
+
+void serialize_write(StrBuilder* b, u16* value) { str_builder_append_varint(b, *value); }
+void serialize_write(StrBuilder* b, u32* value) { str_builder_append_varint(b, *value); }
+void serialize_write(StrBuilder* b, u64* value) { str_builder_append_varint(b, *value); }
+void serialize_write(StrBuilder* b, s16* value) { str_builder_append_zigzag(b, *value); }
+void serialize_write(StrBuilder* b, s32* value) { str_builder_append_zigzag(b, *value); }
+void serialize_write(StrBuilder* b, s64* value) { str_builder_append_zigzag(b, *value); }
+
+inline bool _serialize_read_unsigned(StrParser* p, u64 max, u64* out) {
+    u64 value;
+    if(!str_parser_get_varint(p, &value) || value > max) return false;
+    *out = value;
+    return true;
+}
+
+inline bool _serialize_read_signed(StrParser* p, s64 min, s64 max, s64* out) {
+    s64 value;
+    if(!str_parser_get_zigzag(p, &value) || value < min || value > max) return false;
+    *out = value;
+    return true;
+}
+
+bool serialize_read(StrParser* p, u16* out) { u64 v; if(!_serialize_read_unsigned(p, MAX_U16, &v)) return false; *out = (u16)v; return true; }
+bool serialize_read(StrParser* p, u32* out) { u64 v; if(!_serialize_read_unsigned(p, MAX_U32, &v)) return false; *out = (u32)v; return true; }
+bool serialize_read(StrParser* p, u64* out) { return _serialize_read_unsigned(p, MAX_U64, out); }
+bool serialize_read(StrParser* p, s16* out) { s64 v; if(!_serialize_read_signed(p, -MAX_S16 - 1, MAX_S16, &v)) return false; *out = (s16)v; return true; }
+bool serialize_read(StrParser* p, s32* out) { s64 v; if(!_serialize_read_signed(p, -(s64)MAX_S32 - 1, MAX_S32, &v)) return false; *out = (s32)v; return true; }
+bool serialize_read(StrParser* p, s64* out) { return _serialize_read_signed(p, -(s64)MAX_S64 - 1, MAX_S64, out); }
+
+void serialize_write(StrBuilder* b, str* value) {
+    str_builder_append_varint(b, value->size);
+    str_builder_append(b, *value);
+}
+
+// zero-copy, the str points inside the parser's buffer
+bool serialize_read(StrParser* p, str* out) {
+    u64 size;
+    if(!str_parser_get_varint(p, &size) || size > (u64)p->size) return false;
+    *out = str(p->ptr, (s32)size);
+    str_parser_advance(p, (s32)size);
+    return true;
+}
+
+//
+// arrays
+//
+
+template<typename T> constexpr bool _serialize_is_struct(T*) { return false; }
+
+// which types can be written/read with a single memcpy
+template<typename T> struct _SerializeBulk { static constexpr bool value = __is_trivially_copyable(T); };
+template<> struct _SerializeBulk<str> { static constexpr bool value = false; }; // the bytes are elsewhere
+template<typename T> struct _SerializeBulk<Array<T>> { static constexpr bool value = false; };
+
+template<typename T>
+constexpr bool _serialize_is_bulk() { return _SerializeBulk<T>::value && !_serialize_is_struct((T*)NULL); }
+
+template<typename T>
+void serialize_write(StrBuilder* b, Array<T>* value) {
+    str_builder_append_varint(b, value->size);
+    if(_serialize_is_bulk<T>()) {
+        str_builder_append_raw(b, (u8*)value->ptr, value->size * sizeof(T));
+        return;
+    }
+    for(int i = 0; i < value->size; i++) serialize_write(b, &value->ptr[i]);
+}
+
+// the array is cleared and filled with the elements read (allocating with its own allocator)
+template<typename T>
+bool serialize_read(StrParser* p, Array<T>* out) {
+    u64 count;
+    if(!str_parser_get_varint(p, &count)) return false;
+    // every element takes at least 1 byte, so corrupted data can't make us allocate GBs of memory
+    if(count > (u64)p->size) return false;
+    array_clear(out);
+    array_reserve(out, (s32)count);
+
+    if(_serialize_is_bulk<T>()) {
+        u64 bytes = count * sizeof(T);
+        if(bytes > (u64)p->size) return false;
+        memcpy(out->ptr, p->ptr, bytes);
+        out->size = (s32)count;
+        str_parser_advance(p, (s32)bytes);
+        return true;
+    }
+
+    for(u64 i = 0; i < count; i++) {
+        T element = {};
+        if(!serialize_read(p, &element)) return false;
+        array_append(out, element);
+    }
+    return true;
+}
@@ -11,6 +11,11 @@ Basic benchmarking functionality
 - BENCHMARK_COMPARE to run 2 non-void functions at the same time and give info on the faster one
 - BENCHMARK_VOID_MANY_INPUTS to run a function returning void a given number of times with different inputs
 - BENCHMARK_MANY_INPUTS to run a non-void function a given number of times with different inputs
+- the _BYTES variants of BENCHMARK_WITH_COUNT, BENCHMARK_FUNC and BENCHMARK_COMPARE (and their VOID versions), for functions
+  processing some data: they take how many bytes each call processes and also print the throughput in GB/s (10^9 bytes per second)
+
+With #define HW_COUNTERS 1 (before including performance_counter.h) every benchmark also reports the hardware counters
+(instructions per cycle, cache and branch misses per call, see read_hw_counters), measured over all the runs.
 */
 
 // to quickly deactivate benchmarking without changing code you can #define SIMPLE_BENCHMARK 0 before importing this file
@@ -47,42 +52,73 @@ void print_benchmark_time(u64 cycles) {
     print_benchmark_time(cycles, cpu_frequency);
 }
 
+// prints " | x GB/s" for bytes processed in the given cycles, nothing if bytes is 0
+void print_benchmark_bandwidth(u64 bytes, u64 cycles) {
+    if(bytes == 0 || cycles == 0) return;
+    f64 seconds = (f64)cycles / estimate_cpu_frequency();
+    printsl(" | % GB/s", bytes / seconds / 1000000000.0);
+}
+
+// hardware counters in the benchmarks, they're read outside of the timed code so the times don't change
+#if HW_COUNTERS
+#define _BENCHMARK_HW_DECLARE(total) HwCounters total = {};
+#define _BENCHMARK_HW_START(start) HwCounters start = read_hw_counters();
+#define _BENCHMARK_HW_ADD(total, start) hw_counters_accumulate(&total, start, read_hw_counters());
+#define _BENCHMARK_HW_PRINT(total, calls) { printsl("    "); print_hw_counters(total, calls); print(""); }
+#else
+#define _BENCHMARK_HW_DECLARE(total)
+#define _BENCHMARK_HW_START(start)
+#define _BENCHMARK_HW_ADD(total, start)
+#define _BENCHMARK_HW_PRINT(total, calls)
+#endif
+
 
 /*
 Runs a given function a given number of times with the given inputs.
 If you function returns void you should use BENCHMARK_VOID_WITH_COUNT.
 Usage: BENCHMARK_WITH_COUNT(10000, func_to_run, input1, input2);
+If each call processes some bytes you can use BENCHMARK_WITH_COUNT_BYTES(10000, input.size, func_to_run, input) to get the GB/s too.
 */
-#define BENCHMARK_WITH_COUNT(count, func_name, ...) \
+#define BENCHMARK_WITH_COUNT(count, func_name, ...) BENCHMARK_WITH_COUNT_BYTES(count, 0, func_name, __VA_ARGS__)
+#define BENCHMARK_VOID_WITH_COUNT(count, func_name, ...) BENCHMARK_VOID_WITH_COUNT_BYTES(count, 0, func_name, __VA_ARGS__)
+#define BENCHMARK_WITH_COUNT_BYTES(count, bytes_per_call, func_name, ...) \
 do { \
     u64 min_cycles = MAX_U64; \
+    _BENCHMARK_HW_START(hw_start) \
     for(int i = 0; i < count; i++) { \
         u64 start = read_cpu_timer(); \
         volatile auto temp = func_name(__VA_ARGS__); \
         u64 current_cycles = read_cpu_timer() - start; \
         if(current_cycles < min_cycles) min_cycles = current_cycles; \
     } \
+    _BENCHMARK_HW_DECLARE(hw_total) _BENCHMARK_HW_ADD(hw_total, hw_start) \
     printf("function '%s' x%-10d ", STRING_JOIN( STRING_JOIN( STRING_JOIN(#func_name, "("), #__VA_ARGS__  ) , ")" ), count); \
     printsl("|> min cycles: %", min_cycles); \
+    print_benchmark_bandwidth(bytes_per_call, min_cycles); \
     printsl(" | min time: "); \
     print_benchmark_time(min_cycles); \
+    _BENCHMARK_HW_PRINT(hw_total, count) \
 } while(0)
 
-// alternative to BENCHMARK_WITH_COUNT for functions returning void,
-// if your function returns something you should use BENCHMARK_WITH_COUNT
-#define BENCHMARK_VOID_WITH_COUNT(count, func_name, ...) \
+// alternative to BENCHMARK_WITH_COUNT_BYTES for functions returning void,
+// if your function returns something you should use BENCHMARK_WITH_COUNT_BYTES
+#define BENCHMARK_VOID_WITH_COUNT_BYTES(count, bytes_per_call, func_name, ...) \
 do { \
     u64 min_cycles = MAX_U64; \
+    _BENCHMARK_HW_START(hw_start) \
     for(int i = 0; i < count; i++) { \
         u64 start = read_cpu_timer(); \
         func_name(__VA_ARGS__); \
         u64 current_cycles = read_cpu_timer() - start; \
         if(current_cycles < min_cycles) min_cycles = current_cycles; \
     } \
+    _BENCHMARK_HW_DECLARE(hw_total) _BENCHMARK_HW_ADD(hw_total, hw_start) \
     printf("function '%s' x%-10d ", STRING_JOIN( STRING_JOIN( STRING_JOIN(#func_name, "("), #__VA_ARGS__  ) , ")" ), count); \
     printsl("|> min cycles: %", min_cycles); \
+    print_benchmark_bandwidth(bytes_per_call, min_cycles); \
     printsl(" | min time: "); \
     print_benchmark_time(min_cycles); \
+    _BENCHMARK_HW_PRINT(hw_total, count) \
 } while(0)
 
 /*
@@ -107,18 +143,22 @@ do { \
     const char* tests_inputs_names[] = {STRINGIFY(__VA_ARGS__)}; \
     const int TESTS_INPUTS_COUNT = NUM_ARGS(__VA_ARGS__); \
     u64 tests_mins[TESTS_INPUTS_COUNT] = {}; \
+    _BENCHMARK_HW_DECLARE(tests_hw[TESTS_INPUTS_COUNT]) \
     for(int test_index = 0; test_index < TESTS_INPUTS_COUNT; test_index++) { \
+        _BENCHMARK_HW_START(hw_start) \
         for(int rep = 0; rep < count; rep++) { \
             u64 start = read_cpu_timer(); \
             func_name(tests_inputs[test_index]); \
             u64 current_cycles = read_cpu_timer() - start; \
             if(rep == 0 || current_cycles < tests_mins[test_index]) tests_mins[test_index] = current_cycles; \
         } \
+        _BENCHMARK_HW_ADD(tests_hw[test_index], hw_start) \
         print("completed testing with input %", tests_inputs_names[test_index]); \
     } \
     print("function '%' tested x% times", STRING_JOIN( STRING_JOIN( STRING_JOIN(#func_name, "("), #__VA_ARGS__  ) , ")" ), count); \
     for(int i = 0; i < TESTS_INPUTS_COUNT; i++) { \
         print("input '%': min=% cycles", tests_inputs_names[i], tests_mins[i]); \
+        _BENCHMARK_HW_PRINT(tests_hw[i], count) \
     } \
 } while (0)
 
@@ -130,18 +170,22 @@ do { \
     const char* tests_inputs_names[] = {STRINGIFY(__VA_ARGS__)}; \
     const int TESTS_INPUTS_COUNT = NUM_ARGS(__VA_ARGS__); \
     u64 tests_mins[TESTS_INPUTS_COUNT] = {}; \
+    _BENCHMARK_HW_DECLARE(tests_hw[TESTS_INPUTS_COUNT]) \
     for(int test_index = 0; test_index < TESTS_INPUTS_COUNT; test_index++) { \
+        _BENCHMARK_HW_START(hw_start) \
         for(int rep = 0; rep < count; rep++) { \
             u64 start = read_cpu_timer(); \
             volatile auto temp = func_name(tests_inputs[test_index]); \
             u64 current_cycles = read_cpu_timer() - start; \
             if(rep == 0 || current_cycles < tests_mins[test_index]) tests_mins[test_index] = current_cycles; \
         } \
+        _BENCHMARK_HW_ADD(tests_hw[test_index], hw_start) \
         print("completed testing with input %", tests_inputs_names[test_index]); \
     } \
     print("function '%' tested x% times", STRING_JOIN( STRING_JOIN( STRING_JOIN(#func_name, "("), #__VA_ARGS__  ) , ")" ), count); \
     for(int i = 0; i < TESTS_INPUTS_COUNT; i++) { \
         print("input '%': min=% cycles", tests_inputs_names[i], tests_mins[i]); \
+        _BENCHMARK_HW_PRINT(tests_hw[i], count) \
     } \
 } while (0)
 
@@ -151,13 +195,18 @@ Will run the function until there's a run of 10 seconds with no changes to min e
 If your function returns void you should use BENCHMARK_VOID_FUNC.
 
 Usage: BENCHMARK_FUNC(func_to_test, input_to_func);
+With BENCHMARK_FUNC_BYTES(bytes_per_call, func_to_test, input_to_func) you'll also get the GB/s.
 */
-#define BENCHMARK_FUNC(func_name, ...) \
+#define BENCHMARK_FUNC(func_name, ...) BENCHMARK_FUNC_BYTES(0, func_name, __VA_ARGS__)
+#define BENCHMARK_VOID_FUNC(func_name, ...) BENCHMARK_VOID_FUNC_BYTES(0, func_name, __VA_ARGS__)
+
+#define BENCHMARK_FUNC_BYTES(bytes_per_call, func_name, ...) \
 { \
     u64 freq = estimate_cpu_frequency(); \
     u64 timer_start = read_cpu_timer(); \
     u64 min_time = MAX_U64; \
     u64 count = 0; \
+    _BENCHMARK_HW_START(hw_start) \
     while(true) { \
         u64 current_time = read_cpu_timer(); \
         f64 seconds_elapsed = (current_time - timer_start) / freq; \
@@ -173,18 +222,23 @@ Usage: BENCHMARK_FUNC(func_to_test, input_to_func);
         } \
         count++; \
     } \
+    _BENCHMARK_HW_DECLARE(hw_total) _BENCHMARK_HW_ADD(hw_total, hw_start) \
     print("function '%' tested x% times", STRING_JOIN( STRING_JOIN( STRING_JOIN(#func_name, "("), #__VA_ARGS__  ) , ")" ), count); \
-    print("    min: % cycles", min_time); \
+    printsl("    min: % cycles", min_time); \
+    print_benchmark_bandwidth(bytes_per_call, min_time); \
+    print(""); \
+    _BENCHMARK_HW_PRINT(hw_total, count) \
 }
 
-// Alternative to BENCHMARK_FUNC for functions returning void,
-// if your function returns something you should use BENCHMARK_FUNC
-#define BENCHMARK_VOID_FUNC(func_name, ...) \
+// Alternative to BENCHMARK_FUNC_BYTES for functions returning void,
+// if your function returns something you should use BENCHMARK_FUNC_BYTES
+#define BENCHMARK_VOID_FUNC_BYTES(bytes_per_call, func_name, ...) \
 { \
     u64 freq = estimate_cpu_frequency(); \
     u64 timer_start = read_cpu_timer(); \
     u64 min_time = MAX_U64; \
     u64 count = 0; \
+    _BENCHMARK_HW_START(hw_start) \
     while(true) { \
         u64 current_time = read_cpu_timer(); \
         f64 seconds_elapsed = (current_time - timer_start) / freq; \
@@ -200,8 +254,12 @@ Usage: BENCHMARK_FUNC(func_to_test, input_to_func);
         } \
         count++; \
     } \
+    _BENCHMARK_HW_DECLARE(hw_total) _BENCHMARK_HW_ADD(hw_total, hw_start) \
     print("function '%' tested x% times", STRING_JOIN( STRING_JOIN( STRING_JOIN(#func_name, "("), #__VA_ARGS__  ) , ")" ), count); \
-    print("    min: % cycles", min_time); \
+    printsl("    min: % cycles", min_time); \
+    print_benchmark_bandwidth(bytes_per_call, min_time); \
+    print(""); \
+    _BENCHMARK_HW_PRINT(hw_total, count) \
 }
 
 // TODO(cogno): change BENCHMARK_COMPARE_VOID and BENCHMARK_COMPARE to continue running until they have 10 seconds of the same best time
@@ -213,28 +271,41 @@ If the functions you want to test return some input you should instead use BENCH
 
 Example usage:
 BENCHMARK_COMPARE_VOID(1000, old_func, new_func, optional_input_to_both_functions);
+With BENCHMARK_COMPARE_VOID_BYTES(1000, bytes_per_call, old_func, new_func, inputs) you'll also get the GB/s of both.
 */
-#define BENCHMARK_COMPARE_VOID(count, func1, func2, ...) \
+#define BENCHMARK_COMPARE_VOID(count, func1, func2, ...) BENCHMARK_COMPARE_VOID_BYTES(count, 0, func1, func2, __VA_ARGS__)
+#define BENCHMARK_COMPARE(count, func1, func2, ...) BENCHMARK_COMPARE_BYTES(count, 0, func1, func2, __VA_ARGS__)
+
+#define BENCHMARK_COMPARE_VOID_BYTES(count, bytes_per_call, func1, func2, ...) \
 do { \
     u64 min_cycles_f1 = MAX_U64; \
     u64 min_cycles_f2 = MAX_U64; \
+    _BENCHMARK_HW_DECLARE(hw_f1) _BENCHMARK_HW_DECLARE(hw_f2) \
     for(int i = 0; i < count; i++) { \
         bool switchup = random_bool(); \
         u64 current_cycles_f1, current_cycles_f2; \
         if (switchup) { \
+            _BENCHMARK_HW_START(hw_start_f1) \
             u64 start_f1 = read_cpu_timer(); \
             func1(__VA_ARGS__); \
             current_cycles_f1 = read_cpu_timer() - start_f1; \
+            _BENCHMARK_HW_ADD(hw_f1, hw_start_f1) \
+            _BENCHMARK_HW_START(hw_start_f2) \
             u64 start_f2 = read_cpu_timer(); \
             func2(__VA_ARGS__); \
             current_cycles_f2 = read_cpu_timer() - start_f2; \
+            _BENCHMARK_HW_ADD(hw_f2, hw_start_f2) \
         } else { \
+            _BENCHMARK_HW_START(hw_start_f2) \
             u64 start_f2 = read_cpu_timer(); \
             func2(__VA_ARGS__); \
             current_cycles_f2 = read_cpu_timer() - start_f2; \
+            _BENCHMARK_HW_ADD(hw_f2, hw_start_f2) \
+            _BENCHMARK_HW_START(hw_start_f1) \
             u64 start_f1 = read_cpu_timer(); \
             func1(__VA_ARGS__); \
             current_cycles_f1 = read_cpu_timer() - start_f1; \
+            _BENCHMARK_HW_ADD(hw_f1, hw_start_f1) \
         } \
         if(current_cycles_f1 < min_cycles_f1) min_cycles_f1 = current_cycles_f1; \
         if(current_cycles_f2 < min_cycles_f2) min_cycles_f2 = current_cycles_f2; \
@@ -243,41 +314,54 @@ do { \
     auto f2_name = STRING_JOIN( STRING_JOIN( STRING_JOIN(#func2, "("), #__VA_ARGS__  ) , ")" ); \
     printsl("function '%' x% ", f1_name, count); \
     printsl("|> cycles: %", min_cycles_f1); \
+    print_benchmark_bandwidth(bytes_per_call, min_cycles_f1); \
     printsl(" | time: "); \
     print_benchmark_time(min_cycles_f1); \
+    _BENCHMARK_HW_PRINT(hw_f1, count) \
     printsl("function '%' x% ", f2_name, count); \
     printsl("|> cycles: %", min_cycles_f2); \
+    print_benchmark_bandwidth(bytes_per_call, min_cycles_f2); \
     printsl(" | time: "); \
     print_benchmark_time(min_cycles_f2); \
+    _BENCHMARK_HW_PRINT(hw_f2, count) \
     print("final result when comparing '%' againts '%':", f2_name, f1_name); \
     if(min_cycles_f1 < min_cycles_f2) print("    % more cycles (x% slowdown)", min_cycles_f2 - min_cycles_f1, (f64)min_cycles_f2 / min_cycles_f1); \
     else                              print("    % less cycles (x% speedup)", min_cycles_f1 - min_cycles_f2, (f64)min_cycles_f1 / min_cycles_f2); \
 } while(0)
 
-// Alternative to BENCHMARK_COMPARE_VOID where the input functions return some values.
+// Alternative to BENCHMARK_COMPARE_VOID_BYTES where the input functions return some values.
 // This macro prevents the compiler/optimizer from removing that output, which could
 // interfere with your analysis.
-#define BENCHMARK_COMPARE(count, func1, func2, ...) \
+#define BENCHMARK_COMPARE_BYTES(count, bytes_per_call, func1, func2, ...) \
 do { \
     u64 min_cycles_f1 = MAX_U64; \
     u64 min_cycles_f2 = MAX_U64; \
+    _BENCHMARK_HW_DECLARE(hw_f1) _BENCHMARK_HW_DECLARE(hw_f2) \
     for(int i = 0; i < count; i++) { \
         bool switchup = random_bool(); \
         u64 current_cycles_f1, current_cycles_f2; \
         if (switchup) { \
+            _BENCHMARK_HW_START(hw_start_f1) \
             u64 start_f1 = read_cpu_timer(); \
             volatile auto temp1 = func1(__VA_ARGS__); \
             current_cycles_f1 = read_cpu_timer() - start_f1; \
+            _BENCHMARK_HW_ADD(hw_f1, hw_start_f1) \
+            _BENCHMARK_HW_START(hw_start_f2) \
             u64 start_f2 = read_cpu_timer(); \
             volatile auto temp2 = func2(__VA_ARGS__); \
             current_cycles_f2 = read_cpu_timer() - start_f2; \
+            _BENCHMARK_HW_ADD(hw_f2, hw_start_f2) \
         } else { \
+            _BENCHMARK_HW_START(hw_start_f2) \
             u64 start_f2 = read_cpu_timer(); \
             volatile auto temp2 = func2(__VA_ARGS__); \
             current_cycles_f2 = read_cpu_timer() - start_f2; \
+            _BENCHMARK_HW_ADD(hw_f2, hw_start_f2) \
+            _BENCHMARK_HW_START(hw_start_f1) \
             u64 start_f1 = read_cpu_timer(); \
             volatile auto temp1 = func1(__VA_ARGS__); \
             current_cycles_f1 = read_cpu_timer() - start_f1; \
+            _BENCHMARK_HW_ADD(hw_f1, hw_start_f1) \
         } \
         if(current_cycles_f1 < min_cycles_f1) min_cycles_f1 = current_cycles_f1; \
         if(current_cycles_f2 < min_cycles_f2) min_cycles_f2 = current_cycles_f2; \
@@ -286,12 +370,16 @@ do { \
     auto f2_name = STRING_JOIN( STRING_JOIN( STRING_JOIN(#func2, "("), #__VA_ARGS__  ) , ")" ); \
     printsl("function '%' x% ", f1_name, count); \
     printsl("|> cycles: %", min_cycles_f1); \
+    print_benchmark_bandwidth(bytes_per_call, min_cycles_f1); \
     printsl(" | time: "); \
     print_benchmark_time(min_cycles_f1); \
+    _BENCHMARK_HW_PRINT(hw_f1, count) \
     printsl("function '%' x% ", f2_name, count); \
     printsl("|> cycles: %", min_cycles_f2); \
+    print_benchmark_bandwidth(bytes_per_call, min_cycles_f2); \
     printsl(" | time: "); \
     print_benchmark_time(min_cycles_f2); \
+    _BENCHMARK_HW_PRINT(hw_f2, count) \
     print("final result when comparing '%' againts '%':", f2_name, f1_name); \
     if(min_cycles_f1 < min_cycles_f2) print("    % more cycles (x% slowdown)", min_cycles_f2 - min_cycles_f1, (f64)min_cycles_f2 / min_cycles_f1); \
     else                              print("    % less cycles (x% speedup)", min_cycles_f1 - min_cycles_f2, (f64)min_cycles_f1 / min_cycles_f2); \
@@ -307,5 +395,11 @@ do { \
 #define BENCHMARK_COMPARE(count, func1, func2, ...)
 #define BENCHMARK_VOID_MANY_INPUTS(count, func_name, ...)
 #define BENCHMARK_MANY_INPUTS(count, func_name, ...)
+#define BENCHMARK_FUNC_BYTES(bytes_per_call, func_name, ...)
+#define BENCHMARK_WITH_COUNT_BYTES(count, bytes_per_call, func_name, ...)
+#define BENCHMARK_VOID_FUNC_BYTES(bytes_per_call, func_name, ...)
+#define BENCHMARK_VOID_WITH_COUNT_BYTES(count, bytes_per_call, func_name, ...)
+#define BENCHMARK_COMPARE_VOID_BYTES(count, bytes_per_call, func1, func2, ...)
+#define BENCHMARK_COMPARE_BYTES(count, bytes_per_call, func1, func2, ...)
 
 #endif
@@ -0,0 +1,426 @@
+#pragma once
+#define GYO_SORT
+
+/*
+In this file:
+- array_sort, to sort an Array (or a raw pointer) in ascending order. Integers and floats use an LSD radix sort,
+  anything else a pattern-defeating quicksort (pdqsort) using operator <
+- array_sort_by_key, to sort structs by one of their fields (or anything you compute from them)
+- array_sort_compare, to sort with your own comparison
+- the _parallel versions of all of them, which split the work on the thread pool (thread_pool.h) for big arrays
+
+Example:
+array_sort(&ids);
+array_sort_by_key(&players, [](Player& p) { return p.score; });
+array_sort_compare(&players, [](Player& a, Player& b) { return a.level > b.level; }); // from the highest level
+array_sort_by_key_parallel(&records, [](Record& r) { return r.timestamp; }, make_allocator(&arena));
+
+The radix sort needs a scratch buffer as big as the array, it's taken from the allocator you give (default_allocator if you don't)
+and freed at the end, so an Arena works great. It's stable, the comparison sort is not (and doesn't need any scratch).
+array_sort_by_key uses the radix sort if the key is a number, the comparison sort otherwise.
+Floats are sorted by value, -0 comes before +0 and NaNs go at the start (negative ones) or at the end (positive ones),
+with both sorts (array_sort_compare uses your comparison instead).
+*/
+
+#ifndef DISABLE_INCLUDES
+    #include <string.h> // for memcpy
+#endif
+
+#ifndef GYOFIRST
+    #include "first.h"
+#endif
+
+#ifndef GYO_ALLOCATORS
+    #include "allocators.h"
+#endif
+
+#ifndef GYO_ARRAY
+    #include "array.h"
+#endif
+
+#ifndef GYO_THREAD_POOL
+    #include "thread_pool.h"
+#endif
+
+#define GYO_SORT_INSERTION_THRESHOLD 24     // smaller ranges are insertion sorted
+#define GYO_SORT_NINTHER_THRESHOLD 128      // bigger ranges use the median of 9 elements as pivot
+#define GYO_SORT_RADIX_THRESHOLD 256        // smaller arrays aren't worth the radix sort histograms
+#define GYO_SORT_PARALLEL_THRESHOLD 32768   // smaller ranges aren't worth sending to another thread
+
+//
+// radix keys, every number becomes an unsigned integer with the same order
+//
+
+template<typename T> struct _RadixKey { static constexpr bool radix = false; static u64 bits(T) { return 0; } };
+template<> struct _RadixKey<u8>  { static constexpr bool radix = true; static u64 bits(u8 v)  { return v; } };
+template<> struct _RadixKey<u16> { static constexpr bool radix = true; static u64 bits(u16 v) { return v; } };
+template<> struct _RadixKey<u32> { static constexpr bool radix = true; static u64 bits(u32 v) { return v; } };
+template<> struct _RadixKey<u64> { static constexpr bool radix = true; static u64 bits(u64 v) { return v; } };
+// signed: flipping the sign bit puts negatives before positives
+template<> struct _RadixKey<s8>  { static constexpr bool radix = true; static u64 bits(s8 v)  { return (u8)v ^ 0x80u; } };
+template<> struct _RadixKey<s16> { static constexpr bool radix = true; static u64 bits(s16 v) { return (u16)v ^ 0x8000u; } };
+template<> struct _RadixKey<s32> { static constexpr bool radix = true; static u64 bits(s32 v) { return (u32)v ^ 0x80000000u; } };
+template<> struct _RadixKey<s64> { static constexpr bool radix = true; static u64 bits(s64 v) { return (u64)v ^ 0x8000000000000000ull; } };
+// floats: positives get the sign bit set, negatives get every bit flipped (so bigger magnitudes come first)
+template<> struct _RadixKey<f32> { static constexpr bool radix = true; static u64 bits(f32 v) { u32 b; memcpy(&b, &v, sizeof(b)); return (b & 0x80000000u) ? ~b : (b | 0x80000000u); } };
+template<> struct _RadixKey<f64> { static constexpr bool radix = true; static u64 bits(f64 v) { u64 b; memcpy(&b, &v, sizeof(b)); return (b & 0x8000000000000000ull) ? ~b : (b | 0x8000000000000000ull); } };
+
+// the comparison sort orders keys with <, except floats which are compared like the radix sort does,
+// so NaNs and -0 go to the same place whatever the size of the array
+template<typename K> struct _SortKeyLess { template<typename A, typename B> static bool less(A&& a, B&& b) { return a < b; } };
+template<> struct _SortKeyLess<f32> { static bool less(f32 a, f32 b) { return _RadixKey<f32>::bits(a) < _RadixKey<f32>::bits(b); } };
+template<> struct _SortKeyLess<f64> { static bool less(f64 a, f64 b) { return _RadixKey<f64>::bits(a) < _RadixKey<f64>::bits(b); } };
+
+template<typename T> struct _SortDecay { typedef T type; };
+template<typename T> struct _SortDecay<T&> { typedef T type; };
+template<typename T> struct _SortDecay<const T> { typedef T type; };
+template<typename T> struct _SortDecay<const T&> { typedef T type; };
+
+//
+// pdqsort (Orson Peters, "Pattern-defeating Quicksort"): introsort that detects already sorted/reversed ranges,
+// groups equal elements (so many duplicates are fast) and shuffles around bad pivots before falling back to heapsort
+//
+
+template<typename T>
+inline void _sort_swap(T* a, T* b) { T temp = *a; *a = *b; *b = temp; }
+
+template<typename T, typename Less>
+inline void _sort3(T* a, T* b, T* c, Less& less) {
+    if(less(*b, *a)) _sort_swap(a, b);
+    if(less(*c, *b)) _sort_swap(b, c);
+    if(less(*b, *a)) _sort_swap(a, b);
+}
+
+template<typename T, typename Less>
+void _insertion_sort(T* begin, T* end, Less& less) {
+    for(T* current = begin + 1; current < end; current++) {
+        if(!less(*current, *(current - 1))) continue;
+        T temp = *current;
+        T* sift = current;
+        do { *sift = *(sift - 1); sift--; } while(sift != begin && less(temp, *(sift - 1)));
+        *sift = temp;
+    }
+}
+
+// the element before begin must not be bigger than anything in the range, so we don't need to check for begin
+template<typename T, typename Less>
+void _unguarded_insertion_sort(T* begin, T* end, Less& less) {
+    for(T* current = begin + 1; current < end; current++) {
+        if(!less(*current, *(current - 1))) continue;
+        T temp = *current;
+        T* sift = current;
+        do { *sift = *(sift - 1); sift--; } while(less(temp, *(sift - 1)));
+        *sift = temp;
+    }
+}
+
+// insertion sort which gives up (returning false) if it has to move too many elements, to finish almost sorted ranges
+template<typename T, typename Less>
+bool _partial_insertion_sort(T* begin, T* end, Less& less) {
+    if(begin == end) return true;
+    s64 moved = 0;
+    for(T* current = begin + 1; current < end; current++) {
+        if(less(*current, *(current - 1))) {
+            T temp = *current;
+            T* sift = current;
+            do { *sift = *(sift - 1); sift--; } while(sift != begin && less(temp, *(sift - 1)));
+            *sift = temp;
+            moved += current - sift;
+        }
+        if(moved > 8) return false;
+    }
+    return true;
+}
+
+template<typename T, typename Less>
+void _heap_sift_down(T* heap, s64 size, s64 index, Less& less) {
+    T value = heap[index];
+    while(true) {
+        s64 child = index * 2 + 1;
+        if(child >= size) break;
+        if(child + 1 < size && less(heap[child], heap[child + 1])) child++;
+        if(!less(value, heap[child])) break;
+        heap[index] = heap[child];
+        index = child;
+    }
+    heap[index] = value;
+}
+
+template<typename T, typename Less>
+void _heap_sort(T* begin, T* end, Less& less) {
+    s64 size = end - begin;
+    for(s64 i = size / 2 - 1; i >= 0; i--) _heap_sift_down(begin, size, i, less);
+    for(s64 i = size - 1; i > 0; i--) {
+        _sort_swap(begin, begin + i);
+        _heap_sift_down(begin, i, 0, less);
+    }
+}
+
+// the pivot is *begin, elements equal to it go to the right. Returns where the pivot ends up.
+template<typename T, typename Less>
+T* _partition_right(T* begin, T* end, Less& less, bool* already_partitioned) {
+    T pivot = *begin;
+    T* first = begin;
+    T* last = end;
+    while(less(*++first, pivot)) {} // the median of 3 guarantees there's something not smaller than the pivot
+    if(first - 1 == begin) while(first < last && !less(*--last, pivot)) {}
+    else                   while(!less(*--last, pivot)) {}
+    *already_partitioned = first >= last; // nothing to swap
+    while(first < last) {
+        _sort_swap(first, last);
+        while(less(*++first, pivot)) {}
+        while(!less(*--last, pivot)) {}
+    }
+    T* pivot_position = first - 1;
+    *begin = *pivot_position;
+    *pivot_position = pivot;
+    return pivot_position;
+}
+
+// the pivot is *begin, elements equal to it go to the left. Used when the pivot is equal to the element
+// before the range, so everything equal to it can be skipped.
+template<typename T, typename Less>
+T* _partition_left(T* begin, T* end, Less& less) {
+    T pivot = *begin;
+    T* first = begin;
+    T* last = end;
+    while(less(pivot, *--last)) {}
+    if(last + 1 == end) while(first < last && !less(pivot, *++first)) {}
+    else                while(!less(pivot, *++first)) {}
+    while(first < last) {
+        _sort_swap(first, last);
+        while(less(pivot, *--last)) {}
+        while(!less(pivot, *++first)) {}
+    }
+    T* pivot_position = last;
+    *begin = *pivot_position;
+    *pivot_position = pivot;
+    return pivot_position;
+}
+
+// leftmost is false when the element before begin is a pivot, no bigger than anything in the range.
+// With a pool, the two sides of big partitions are sorted in parallel.
+template<typename T, typename Less>
+void _pdqsort(T* begin, T* end, Less& less, s32 bad_allowed, bool leftmost, ThreadPool* pool) {
+    while(true) {
+        s64 size = end - begin;
+        if(size < GYO_SORT_INSERTION_THRESHOLD) {
+            if(leftmost) _insertion_sort(begin, end, less);
+            else _unguarded_insertion_sort(begin, end, less);
+            return;
+        }
+
+        // choose the pivot and put it in *begin
+        s64 half = size / 2;
+        if(size > GYO_SORT_NINTHER_THRESHOLD) {
+            _sort3(begin, begin + half, end - 1, less);
+            _sort3(begin + 1, begin + (half - 1), end - 2, less);
+            _sort3(begin + 2, begin + (half + 1), end - 3, less);
+            _sort3(begin + (half - 1), begin + half, begin + (half + 1), less);
+            _sort_swap(begin, begin + half);
+        } else {
+            _sort3(begin + half, begin, end - 1, less);
+        }
+
+        // the pivot is equal to the one before the range, so we put all the elements equal to it on the left and skip them
+        if(!leftmost && !less(*(begin - 1), *begin)) {
+            begin = _partition_left(begin, end, less) + 1;
+            continue;
+        }
+
+        bool already_partitioned;
+        T* pivot = _partition_right(begin, end, less, &already_partitioned);
+        s64 left_size = pivot - begin;
+        s64 right_size = end - (pivot + 1);
+
+        if(left_size < size / 8 || right_size < size / 8) {
+            // bad pivot, too many and we switch to heapsort so we never go quadratic
+            if(--bad_allowed == 0) {
+                _heap_sort(begin, end, less);
+                return;
+            }
+            // shuffle some elements to break the pattern that gave us this pivot
+            if(left_size >= GYO_SORT_INSERTION_THRESHOLD) {
+                _sort_swap(begin, begin + left_size / 4);
+                _sort_swap(pivot - 1, pivot - left_size / 4);
+                if(left_size > GYO_SORT_NINTHER_THRESHOLD) {
+                    _sort_swap(begin + 1, begin + (left_size / 4 + 1));
+                    _sort_swap(begin + 2, begin + (left_size / 4 + 2));
+                    _sort_swap(pivot - 2, pivot - (left_size / 4 + 1));
+                    _sort_swap(pivot - 3, pivot - (left_size / 4 + 2));
+                }
+            }
+            if(right_size >= GYO_SORT_INSERTION_THRESHOLD) {
+                _sort_swap(pivot + 1, pivot + (1 + right_size / 4));
+                _sort_swap(end - 1, end - right_size / 4);
+                if(right_size > GYO_SORT_NINTHER_THRESHOLD) {
+                    _sort_swap(pivot + 2, pivot + (2 + right_size / 4));
+                    _sort_swap(pivot + 3, pivot + (3 + right_size / 4));
+                    _sort_swap(end - 2, end - (1 + right_size / 4));
+                    _sort_swap(end - 3, end - (2 + right_size / 4));
+                }
+            }
+        } else if(already_partitioned && _partial_insertion_sort(begin, pivot, less) && _partial_insertion_sort(pivot + 1, end, less)) {
+            return; // it was (almost) sorted already
+        }
+
+        if(pool != NULL && left_size >= GYO_SORT_PARALLEL_THRESHOLD && right_size >= GYO_SORT_PARALLEL_THRESHOLD) {
+            // pivots never move again, so the two sides can be sorted at the same time
+            T* left_begin = begin;
+            parallel_range(pool, 0, 2, 1, [&](s64 side) {
+                if(side == 0) _pdqsort(left_begin, pivot, less, bad_allowed, leftmost, pool);
+                else _pdqsort(pivot + 1, end, less, bad_allowed, false, pool);
+            });
+            return;
+        }
+
+        _pdqsort(begin, pivot, less, bad_allowed, leftmost, pool);
+        begin = pivot + 1;
+        leftmost = false;
+    }
+}
+
+template<typename T, typename Less>
+void _sort_compare(T* ptr, s32 size, Less& less, ThreadPool* pool) {
+    if(size <= 1) return;
+    s32 log2 = 0;
+    while((1ll << (log2 + 1)) <= size) log2++;
+    _pdqsort(ptr, ptr + size, less, log2, true, pool);
+}
+
+//
+// LSD radix sort, 8 bits at a time starting from the lowest ones. Each pass is a stable counting sort into the
+// scratch buffer and back, the passes where every key has the same byte are skipped.
+//
+
+template<typename T, typename Key>
+void _radix_sort(T* ptr, s32 size, Key& key, Allocator scratch) {
+    typedef typename _SortDecay<decltype(key(*ptr))>::type KeyType;
+    const s32 passes = sizeof(KeyType);
+    s64 counts[sizeof(KeyType)][256] = {};
+    for(s32 i = 0; i < size; i++) {
+        u64 bits = _RadixKey<KeyType>::bits(key(ptr[i]));
+        for(s32 p = 0; p < passes; p++) counts[p][(bits >> (8 * p)) & 0xFF]++;
+    }
+
+    ASSERT_ALWAYS((s64)size * sizeof(T) <= MAX_S32, "array too big to sort (% bytes)", (s64)size * sizeof(T));
+    T* buffer = (T*)mem_alloc(scratch, size * sizeof(T));
+    T* src = ptr;
+    T* dest = buffer;
+    for(s32 p = 0; p < passes; p++) {
+        u64 first_digit = (_RadixKey<KeyType>::bits(key(src[0])) >> (8 * p)) & 0xFF;
+        if(counts[p][first_digit] == size) continue; // all the same, nothing to do
+
+        s64 offsets[256];
+        s64 total = 0;
+        for(s32 d = 0; d < 256; d++) { offsets[d] = total; total += counts[p][d]; }
+        for(s32 i = 0; i < size; i++) {
+            u64 digit = (_RadixKey<KeyType>::bits(key(src[i])) >> (8 * p)) & 0xFF;
+            dest[offsets[digit]++] = src[i];
+        }
+        T* temp = src; src = dest; dest = temp;
+    }
+    if(src != ptr) memcpy(ptr, src, size * sizeof(T));
+    mem_free(scratch, buffer, size * sizeof(T));
+}
+
+// the array is split in blocks, one for each thread. For each pass every block counts its digits, then from all the counts
+// each block knows exactly where its elements go, and they all move them at the same time.
+template<typename T, typename Key>
+void _radix_sort_parallel(T* ptr, s32 size, Key& key, Allocator scratch, ThreadPool* pool) {
+    typedef typename _SortDecay<decltype(key(*ptr))>::type KeyType;
+    const s32 passes = sizeof(KeyType);
+    s32 blocks = min(pool->thread_count + 1, size / (GYO_SORT_PARALLEL_THRESHOLD / 2));
+    if(blocks <= 1) return _radix_sort(ptr, size, key, scratch);
+    s64 block_size = (size + blocks - 1) / blocks;
+
+    ASSERT_ALWAYS((s64)size * sizeof(T) <= MAX_S32, "array too big to sort (% bytes)", (s64)size * sizeof(T));
+    T* buffer = (T*)mem_alloc(scratch, size * sizeof(T));
+    s64* counts = (s64*)mem_alloc(scratch, blocks * 256 * sizeof(s64)); // counts[block * 256 + digit], then the offsets
+    T* src = ptr;
+    T* dest = buffer;
+    for(s32 p = 0; p < passes; p++) {
+        s32 shift = 8 * p;
+        parallel_range(pool, 0, blocks, 1, [&](s64 block) {
+            s64* block_counts = counts + block * 256;
+            memset(block_counts, 0, 256 * sizeof(s64));
+            s64 end = min(block_size * (block + 1), (s64)size);
+            for(s64 i = block_size * block; i < end; i++) block_counts[(_RadixKey<KeyType>::bits(key(src[i])) >> shift) & 0xFF]++;
+        });
+
+        u64 first_digit = (_RadixKey<KeyType>::bits(key(src[0])) >> shift) & 0xFF;
+        s64 first_count = 0;
+        for(s32 b = 0; b < blocks; b++) first_count += counts[b * 256 + first_digit];
+        if(first_count == size) continue; // all the same, nothing to do
+
+        // digit by digit, block by block, so each block's elements go after the previous blocks' (stable)
+        s64 total = 0;
+        for(s32 d = 0; d < 256; d++) {
+            for(s32 b = 0; b < blocks; b++) {
+                s64 count = counts[b * 256 + d];
+                counts[b * 256 + d] = total;
+                total += count;
+            }
+        }
+
+        parallel_range(pool, 0, blocks, 1, [&](s64 block) {
+            s64* offsets = counts + block * 256;
+            s64 end = min(block_size * (block + 1), (s64)size);
+            for(s64 i = block_size * block; i < end; i++) {
+                u64 digit = (_RadixKey<KeyType>::bits(key(src[i])) >> shift) & 0xFF;
+                dest[offsets[digit]++] = src[i];
+            }
+        });
+        T* temp = src; src = dest; dest = temp;
+    }
+    if(src != ptr) {
+        parallel_range_chunks(pool, 0, size, 0, [&](s64 begin, s64 end) { memcpy(ptr + begin, src + begin, (end - begin) * sizeof(T)); });
+    }
+    mem_free(scratch, counts, blocks * 256 * sizeof(s64));
+    mem_free(scratch, buffer, size * sizeof(T));
+}
+
+template<typename T, typename Key>
+void _sort_by_key(T* ptr, s32 size, Key& key, Allocator scratch, ThreadPool* pool) {
+    if(size <= 1) return;
+    typedef typename _SortDecay<decltype(key(*ptr))>::type KeyType;
+    if(!_RadixKey<KeyType>::radix || size < GYO_SORT_RADIX_THRESHOLD) {
+        auto less = [&key](T& a, T& b) { return _SortKeyLess<KeyType>::less(key(a), key(b)); };
+        return _sort_compare(ptr, size, less, pool);
+    }
+    if(pool != NULL) _radix_sort_parallel(ptr, size, key, scratch, pool);
+    else _radix_sort(ptr, size, key, scratch);
+}
+
+//
+// raw pointers
+//
+
+template<typename T> void array_sort(T* ptr, s32 size, Allocator scratch) { auto key = [](T& value) -> T& { return value; }; _sort_by_key(ptr, size, key, scratch, NULL); }
+template<typename T> void array_sort(T* ptr, s32 size) { array_sort(ptr, size, default_allocator); }
+template<typename T, typename Key> void array_sort_by_key(T* ptr, s32 size, Key key, Allocator scratch) { _sort_by_key(ptr, size, key, scratch, NULL); }
+template<typename T, typename Key> void array_sort_by_key(T* ptr, s32 size, Key key) { _sort_by_key(ptr, size, key, default_allocator, NULL); }
+// less(a, b) must return true if a goes before b
+template<typename T, typename Less> void array_sort_compare(T* ptr, s32 size, Less less) { _sort_compare(ptr, size, less, NULL); }
+
+template<typename T> void array_sort_parallel(T* ptr, s32 size, Allocator scratch) { auto key = [](T& value) -> T& { return value; }; _sort_by_key(ptr, size, key, scratch, thread_pool_default()); }
+template<typename T> void array_sort_parallel(T* ptr, s32 size) { array_sort_parallel(ptr, size, default_allocator); }
+template<typename T, typename Key> void array_sort_by_key_parallel(T* ptr, s32 size, Key key, Allocator scratch) { _sort_by_key(ptr, size, key, scratch, thread_pool_default()); }
+template<typename T, typename Key> void array_sort_by_key_parallel(T* ptr, s32 size, Key key) { _sort_by_key(ptr, size, key, default_allocator, thread_pool_default()); }
+template<typename T, typename Less> void array_sort_compare_parallel(T* ptr, s32 size, Less less) { _sort_compare(ptr, size, less, thread_pool_default()); }
+
+//
+// Array overloads, pretty obvious
+//
+
+template<typename T> void array_sort(Array<T>* array, Allocator scratch) { array_sort(array->ptr, array->size, scratch); }
+template<typename T> void array_sort(Array<T>* array) { array_sort(array->ptr, array->size, default_allocator); }
+template<typename T, typename Key> void array_sort_by_key(Array<T>* array, Key key, Allocator scratch) { array_sort_by_key(array->ptr, array->size, key, scratch); }
+template<typename T, typename Key> void array_sort_by_key(Array<T>* array, Key key) { array_sort_by_key(array->ptr, array->size, key, default_allocator); }
+template<typename T, typename Less> void array_sort_compare(Array<T>* array, Less less) { array_sort_compare(array->ptr, array->size, less); }
+
+template<typename T> void array_sort_parallel(Array<T>* array, Allocator scratch) { array_sort_parallel(array->ptr, array->size, scratch); }
+template<typename T> void array_sort_parallel(Array<T>* array) { array_sort_parallel(array->ptr, array->size, default_allocator); }
+template<typename T, typename Key> void array_sort_by_key_parallel(Array<T>* array, Key key, Allocator scratch) { array_sort_by_key_parallel(array->ptr, array->size, key, scratch); }
+template<typename T, typename Key> void array_sort_by_key_parallel(Array<T>* array, Key key) { array_sort_by_key_parallel(array->ptr, array->size, key, default_allocator); }
+template<typename T, typename Less> void array_sort_compare_parallel(Array<T>* array, Less less) { array_sort_compare_parallel(array->ptr, array->size, less); }
@@ -1,15 +1,23 @@
 #pragma once
+#define GYO_STR
 
 /*
 In this file:
-- unicode utility functions
+- unicode utility functions, with fast (SIMD) utf8 validation, codepoint counting and utf8 <-> utf16/utf32 transcoding
 - str, a simple replacement to std::string, simply told, a ptr to char array + size, making them more useful in many situations.
-- StrBuilder, a simple way to dynamically construct str (since str is an array of bytes you can use str_builder to also build binary files and many other things!)
+- StrBuilder, a simple way to dynamically construct str (since str is an array of bytes you can use str_builder to also build binary files and many other things!), with a chunked mode for very big outputs
 - StrParser, a simple way to dynamically DEconstruct a str (since str is an array of bytes you can use str_parser to also parse binary files and many other things!)
 */
 
 #ifndef DISABLE_INCLUDES
     #include <string.h> // for memcpy
+    #include <smmintrin.h> // for sse up to 4.1, used to validate and transcode unicode
+    #ifdef _MSC_VER
+        #include <intrin.h> // for _BitScanForward64
+    #endif
+    #ifndef _WIN32
+        #include <sys/uio.h> // for writev
+    #endif
 #endif
 
 #ifndef GYOFIRST
@@ -17,6 +25,18 @@ In this file:
 #endif
 
 #define GYO_STR_BUILDER_DEFAULT_SIZE 100
+#define GYO_STR_BUILDER_CHUNK_SIZE (1024 * 1024)
+
+// index of the lowest set bit, v must NOT be 0
+inline s32 _bit_scan_forward_u64(u64 v) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, v);
+    return (s32)index;
+#else
+    return __builtin_ctzll(v);
+#endif
+}
 
 //
 // UNICODE UTILS
@@ -60,6 +80,67 @@ u32 unicode_utf8_to_codepoint(u8* utf8) {
     return codepoint;
 }
 
+// Safe alternative to unicode_utf8_to_codepoint for input you don't trust.
+// Reads at most 'available' bytes, returns how many bytes the codepoint used (from 1 to 4)
+// and optionally fills 'out_codepoint'. Returns 0 if the bytes are not valid utf8
+// (invalid headers, missing/extra continuation bytes, overlong encodings, surrogates and codepoints above U+10FFFF).
+s8 unicode_utf8_decode(u8* utf8, s32 available, u32* out_codepoint) {
+    if(available <= 0) return 0;
+    u8 head = utf8[0];
+    if(head < 0x80) {
+        if(out_codepoint != NULL) *out_codepoint = head;
+        return 1;
+    }
+
+    s8 size = 0;
+    u32 codepoint = 0;
+    u32 min_codepoint = 0;
+    if     ((head & 0xE0) == 0xC0) { size = 2; codepoint = head & 0x1F; min_codepoint = 0x80; }
+    else if((head & 0xF0) == 0xE0) { size = 3; codepoint = head & 0x0F; min_codepoint = 0x800; }
+    else if((head & 0xF8) == 0xF0) { size = 4; codepoint = head & 0x07; min_codepoint = 0x10000; }
+    else return 0; // continuation byte or invalid header
+    if(available < size) return 0; // truncated
+
+    for(int i = 1; i < size; i++) {
+        u8 portion = utf8[i];
+        if((portion & 0xC0) != 0x80) return 0; // not a continuation byte
+        codepoint = (codepoint << 6) + (portion & 0x3F);
+    }
+
+    if(codepoint < min_codepoint) return 0; // overlong encoding
+    if(codepoint > 0x10FFFF) return 0; // out of unicode range
+    if(codepoint >= 0xD800 && codepoint <= 0xDFFF) return 0; // surrogates are only valid in utf16
+    if(out_codepoint != NULL) *out_codepoint = codepoint;
+    return size;
+}
+
+// Same as unicode_utf8_decode but for utf16. Returns how many u16 were used (1, or 2 for surrogate pairs),
+// or 0 if the input is not valid utf16 (lone or swapped surrogates).
+s8 unicode_utf16_decode(u16* utf16, s32 available, u32* out_codepoint) {
+    if(available <= 0) return 0;
+    u16 first = utf16[0];
+    if(first < 0xD800 || first > 0xDFFF) {
+        if(out_codepoint != NULL) *out_codepoint = first;
+        return 1;
+    }
+    if(first > 0xDBFF) return 0; // low surrogate without the high one
+    if(available < 2) return 0;  // truncated surrogate pair
+    u16 second = utf16[1];
+    if(second < 0xDC00 || second > 0xDFFF) return 0; // high surrogate without the low one
+    if(out_codepoint != NULL) *out_codepoint = 0x10000 + ((u32)(first - 0xD800) << 10) + (second - 0xDC00);
+    return 2;
+}
+
+// writes the utf8 bytes of a codepoint into dest (which must have at least 4 bytes), returns how many bytes were written
+s8 unicode_codepoint_write_utf8(u32 codepoint, u8* dest) {
+    s8 size = unicode_codepoint_to_size(codepoint);
+    u32 utf8 = unicode_codepoint_to_utf8(codepoint);
+    for(int i = 0; i < size; i++) {
+        dest[i] = (u8)(utf8 >> (8 * (size - 1 - i))); // unicode_codepoint_to_utf8 puts the header in the highest byte
+    }
+    return size;
+}
+
 // implemented manually to avoid the strlen dependency
 int c_string_length(const char* s) {
     int len = 0;
@@ -101,7 +182,7 @@ struct str{
 };
 
 // NOTE(cogno): you can directly cast a const char* to a str (so you can do str name = "YourName"; and it will work)
-inline void printsl_custom(str v) { for(int i = 0; i < v.size; i++) printsl_custom((char)v.ptr[i]); }
+inline void printsl_custom(str v) { _print_buffer_append((const char*)v.ptr, v.size); }
 
 const char* str_to_c_string(str to_convert, void* dest, int dest_size) {
     ASSERT(dest != NULL, "NULL dest buffer given");
@@ -336,18 +417,32 @@ int str_count(str to_check, char to_count) {
     return the_count;
 }
 
-// supports unicode utf8
-u32 str_length_in_char(str string) {
-    u32 char_count = 0;
-    int read_index = 0;
-    while(true) {
-        if (read_index >= string.size) return char_count;
-        ASSERT(read_index < string.size, "reading out of memory");
-        u8 unicode_header = string[read_index];
-        u8 unicode_size = unicode_utf8_to_size(unicode_header);
-        read_index += unicode_size;
-        char_count++;
+// counts bytes bigger than 'threshold' (as a *signed* byte) 16 at a time.
+// The counters are kept per byte and summed every 255 iterations (before they can overflow).
+u32 _simd_count_bytes_greater(u8* ptr, s32 size, s8 threshold) {
+    u32 count = 0;
+    s32 index = 0;
+    __m128i thresholds = _mm_set1_epi8(threshold);
+    while(index + 16 <= size) {
+        __m128i counters = _mm_setzero_si128();
+        for(int i = 0; i < 255 && index + 16 <= size; i++, index += 16) {
+            __m128i bytes = _mm_loadu_si128((__m128i*)(ptr + index));
+            counters = _mm_sub_epi8(counters, _mm_cmpgt_epi8(bytes, thresholds)); // cmpgt gives -1 on each match
+        }
+        __m128i sums = _mm_sad_epu8(counters, _mm_setzero_si128()); // sums 8 bytes at a time into 2 u64
+        count += _mm_cvtsi128_si32(sums) + _mm_extract_epi16(sums, 4);
+    }
+    for(; index < size; index++) {
+        if((s8)ptr[index] > threshold) count++;
     }
+    return count;
+}
+
+// supports unicode utf8, assumes the string is valid (you can check with str_is_valid_utf8)
+u32 str_length_in_char(str string) {
+    // each codepoint has exactly 1 byte which is not a continuation byte (10xxxxxx),
+    // as signed bytes the continuation ones are all the values from -128 to -65
+    return _simd_count_bytes_greater(string.ptr, string.size, -65);
 }
 
 bool str_matches(str a, str b) {
@@ -365,26 +460,410 @@ bool str_contains(str to_check, char to_find) {
     return false;
 }
 
+// parses the name of any ENUM/ENUM_FLAGS value (see first.h), returns false if it's not one of them
+template<typename EnumName>
+bool from_string(str name, EnumName* out) { return from_string((const char*)name.ptr, name.size, out); }
+
 // API(cogno): not a big fan of this. Right now we use for the HashMap, can we avoid it? str_matches is much more explicit.
 inline bool operator ==(str a, str b) {return str_matches(a,b);}
 
+//
+// UNICODE VALIDATION AND TRANSCODING
+// str_is_valid_utf8 checks 16 bytes at a time with the lookup algorithm from
+// "Validating UTF-8 In Less Than One Instruction Per Byte" (Keiser, Lemire), the same used by simdjson.
+// Each error is found by looking at the high and low nibble of a byte and at the high nibble of the next one,
+// 3 table lookups (shuffles) tell us which errors each pair of bytes could be, if all 3 agree it's an error.
+// Transcoders copy ascii 16 bytes at a time and fall back to the (validating) scalar decoders otherwise.
+//
+
+#define _UTF8_TOO_SHORT      (1 << 0) // 11______ 0_______ or 11______ 11______
+#define _UTF8_TOO_LONG       (1 << 1) // 0_______ 10______
+#define _UTF8_OVERLONG_3     (1 << 2) // 11100000 100_____
+#define _UTF8_TOO_LARGE      (1 << 3) // 11110100 1001____ and bigger
+#define _UTF8_SURROGATE      (1 << 4) // 11101101 101_____
+#define _UTF8_OVERLONG_2     (1 << 5) // 1100000_ 10______
+#define _UTF8_TOO_LARGE_1000 (1 << 6) // 11110101 1000____ and bigger
+#define _UTF8_OVERLONG_4     (1 << 6) // 11110000 1000____
+#define _UTF8_TWO_CONTS      (1 << 7) // 10______ 10______
+#define _UTF8_CARRY          (_UTF8_TOO_SHORT | _UTF8_TOO_LONG | _UTF8_TWO_CONTS) // errors that only depend on the high nibble of the first byte
+
+// which errors are possible given the high nibble of the first byte
+const u8 _UTF8_BYTE_1_HIGH_TABLE[16] = {
+    _UTF8_TOO_LONG, _UTF8_TOO_LONG, _UTF8_TOO_LONG, _UTF8_TOO_LONG, _UTF8_TOO_LONG, _UTF8_TOO_LONG, _UTF8_TOO_LONG, _UTF8_TOO_LONG, // ascii
+    _UTF8_TWO_CONTS, _UTF8_TWO_CONTS, _UTF8_TWO_CONTS, _UTF8_TWO_CONTS, // continuation
+    _UTF8_TOO_SHORT | _UTF8_OVERLONG_2, // 1100____
+    _UTF8_TOO_SHORT,                    // 1101____
+    _UTF8_TOO_SHORT | _UTF8_OVERLONG_3 | _UTF8_SURROGATE, // 1110____
+    _UTF8_TOO_SHORT | _UTF8_TOO_LARGE | _UTF8_TOO_LARGE_1000 | _UTF8_OVERLONG_4, // 1111____
+};
+
+// which errors are possible given the low nibble of the first byte
+const u8 _UTF8_BYTE_1_LOW_TABLE[16] = {
+    _UTF8_CARRY | _UTF8_OVERLONG_3 | _UTF8_OVERLONG_2 | _UTF8_OVERLONG_4, // ____0000
+    _UTF8_CARRY | _UTF8_OVERLONG_2, // ____0001
+    _UTF8_CARRY,
+    _UTF8_CARRY,
+    _UTF8_CARRY | _UTF8_TOO_LARGE, // ____0100
+    _UTF8_CARRY | _UTF8_TOO_LARGE | _UTF8_TOO_LARGE_1000,
+    _UTF8_CARRY | _UTF8_TOO_LARGE | _UTF8_TOO_LARGE_1000,
+    _UTF8_CARRY | _UTF8_TOO_LARGE | _UTF8_TOO_LARGE_1000,
+    _UTF8_CARRY | _UTF8_TOO_LARGE | _UTF8_TOO_LARGE_1000,
+    _UTF8_CARRY | _UTF8_TOO_LARGE | _UTF8_TOO_LARGE_1000,
+    _UTF8_CARRY | _UTF8_TOO_LARGE | _UTF8_TOO_LARGE_1000,
+    _UTF8_CARRY | _UTF8_TOO_LARGE | _UTF8_TOO_LARGE_1000,
+    _UTF8_CARRY | _UTF8_TOO_LARGE | _UTF8_TOO_LARGE_1000,
+    _UTF8_CARRY | _UTF8_TOO_LARGE | _UTF8_TOO_LARGE_1000 | _UTF8_SURROGATE, // ____1101
+    _UTF8_CARRY | _UTF8_TOO_LARGE | _UTF8_TOO_LARGE_1000,
+    _UTF8_CARRY | _UTF8_TOO_LARGE | _UTF8_TOO_LARGE_1000,
+};
+
+// which errors are possible given the high nibble of the second byte
+const u8 _UTF8_BYTE_2_HIGH_TABLE[16] = {
+    _UTF8_TOO_SHORT, _UTF8_TOO_SHORT, _UTF8_TOO_SHORT, _UTF8_TOO_SHORT, _UTF8_TOO_SHORT, _UTF8_TOO_SHORT, _UTF8_TOO_SHORT, _UTF8_TOO_SHORT, // ascii
+    _UTF8_TOO_LONG | _UTF8_OVERLONG_2 | _UTF8_TWO_CONTS | _UTF8_OVERLONG_3 | _UTF8_TOO_LARGE_1000 | _UTF8_OVERLONG_4, // 1000____
+    _UTF8_TOO_LONG | _UTF8_OVERLONG_2 | _UTF8_TWO_CONTS | _UTF8_OVERLONG_3 | _UTF8_TOO_LARGE, // 1001____
+    _UTF8_TOO_LONG | _UTF8_OVERLONG_2 | _UTF8_TWO_CONTS | _UTF8_SURROGATE  | _UTF8_TOO_LARGE, // 101_____
+    _UTF8_TOO_LONG | _UTF8_OVERLONG_2 | _UTF8_TWO_CONTS | _UTF8_SURROGATE  | _UTF8_TOO_LARGE,
+    _UTF8_TOO_SHORT, _UTF8_TOO_SHORT, _UTF8_TOO_SHORT, _UTF8_TOO_SHORT, // 11______
+};
+
+// the last 3 bytes of a block are 'incomplete' if they start a codepoint which doesn't fit in the block
+const u8 _UTF8_MAX_COMPLETE_VALUES[16] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xF0 - 1, 0xE0 - 1, 0xC0 - 1,
+};
+
+inline __m128i _simd_high_nibbles(__m128i v) { return _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0x0F)); }
+
+// checks the next 16 bytes of utf8, accumulating any error found into 'error'
+inline void _utf8_check_block(__m128i input, __m128i* prev_input, __m128i* prev_incomplete, __m128i* error) {
+    if(_mm_movemask_epi8(input) == 0) {
+        // only ascii, the only possible error is the previous block ending with an incomplete codepoint
+        *error = _mm_or_si128(*error, *prev_incomplete);
+        *prev_incomplete = _mm_setzero_si128();
+        *prev_input = input;
+        return;
+    }
+
+    // prev1 is input shifted by 1 byte, where the first byte comes from the previous block (and same for prev2, prev3)
+    __m128i prev1 = _mm_alignr_epi8(input, *prev_input, 16 - 1);
+    __m128i byte_1_high = _mm_shuffle_epi8(_mm_loadu_si128((__m128i*)_UTF8_BYTE_1_HIGH_TABLE), _simd_high_nibbles(prev1));
+    __m128i byte_1_low  = _mm_shuffle_epi8(_mm_loadu_si128((__m128i*)_UTF8_BYTE_1_LOW_TABLE), _mm_and_si128(prev1, _mm_set1_epi8(0x0F)));
+    __m128i byte_2_high = _mm_shuffle_epi8(_mm_loadu_si128((__m128i*)_UTF8_BYTE_2_HIGH_TABLE), _simd_high_nibbles(input));
+    __m128i special_cases = _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+
+    // 3 and 4 byte codepoints need their 3rd and 4th bytes to be continuations, which the tables above can't see
+    __m128i prev2 = _mm_alignr_epi8(input, *prev_input, 16 - 2);
+    __m128i prev3 = _mm_alignr_epi8(input, *prev_input, 16 - 3);
+    __m128i is_third_byte  = _mm_subs_epu8(prev2, _mm_set1_epi8((char)(0xE0 - 0x80))); // only 111_____ will be >= 0x80
+    __m128i is_fourth_byte = _mm_subs_epu8(prev3, _mm_set1_epi8((char)(0xF0 - 0x80))); // only 1111____ will be >= 0x80
+    __m128i must_be_continuation = _mm_and_si128(_mm_or_si128(is_third_byte, is_fourth_byte), _mm_set1_epi8((char)0x80));
+
+    // a byte which must be a continuation is marked as TWO_CONTS by the tables, xor cancels the expected ones
+    *error = _mm_or_si128(*error, _mm_xor_si128(must_be_continuation, special_cases));
+    *prev_incomplete = _mm_subs_epu8(input, _mm_loadu_si128((__m128i*)_UTF8_MAX_COMPLETE_VALUES));
+    *prev_input = input;
+}
+
+// Returns true if the string is valid utf8 (no invalid headers, missing/extra continuation bytes,
+// overlong encodings, surrogates or codepoints above U+10FFFF). Checks 16 bytes at a time,
+// use this before working on input you don't trust (unicode_utf8_to_codepoint and str_length_in_char don't check).
+bool str_is_valid_utf8(str to_check) {
+    __m128i error = _mm_setzero_si128();
+    __m128i prev_input = _mm_setzero_si128();
+    __m128i prev_incomplete = _mm_setzero_si128();
+
+    s32 index = 0;
+    for(; index + 16 <= to_check.size; index += 16) {
+        __m128i input = _mm_loadu_si128((__m128i*)(to_check.ptr + index));
+        _utf8_check_block(input, &prev_input, &prev_incomplete, &error);
+    }
+    if(index < to_check.size) {
+        // the zeros after the end count as ascii, so a truncated codepoint is an error as it should be
+        u8 last_block[16] = {};
+        memcpy(last_block, to_check.ptr + index, to_check.size - index);
+        _utf8_check_block(_mm_loadu_si128((__m128i*)last_block), &prev_input, &prev_incomplete, &error);
+    }
+    error = _mm_or_si128(error, prev_incomplete);
+    return _mm_testz_si128(error, error);
+}
+
+// how many u16 are needed to convert the str into utf16, assumes the string is valid utf8
+s32 str_utf16_length(str s) {
+    // codepoints of 4 bytes become surrogate pairs, as signed bytes their headers (11110xxx) are bigger than -17
+    // but so is ascii, so we remove it
+    u32 four_byte_headers = _simd_count_bytes_greater(s.ptr, s.size, -17) - _simd_count_bytes_greater(s.ptr, s.size, -1);
+    return str_length_in_char(s) + four_byte_headers;
+}
+
+// how many u32 are needed to convert the str into utf32, assumes the string is valid utf8
+s32 str_utf32_length(str s) { return str_length_in_char(s); }
+
+// Converts the str into utf16, writing at most dest_size u16 and filling out_written with how many were written.
+// Returns false (without finishing) if the string is not valid utf8 or dest is not big enough.
+bool str_to_utf16(str s, u16* dest, s32 dest_size, s32* out_written) {
+    ASSERT(dest != NULL || dest_size == 0, "NULL dest buffer given");
+    s32 read = 0;
+    s32 written = 0;
+    bool ok = true;
+    while(read < s.size) {
+        if(read + 16 <= s.size && written + 16 <= dest_size) {
+            __m128i bytes = _mm_loadu_si128((__m128i*)(s.ptr + read));
+            s32 non_ascii = _mm_movemask_epi8(bytes);
+            if(non_ascii == 0) {
+                // 16 ascii characters, simply widen them to u16
+                _mm_storeu_si128((__m128i*)(dest + written),     _mm_unpacklo_epi8(bytes, _mm_setzero_si128()));
+                _mm_storeu_si128((__m128i*)(dest + written + 8), _mm_unpackhi_epi8(bytes, _mm_setzero_si128()));
+                read += 16;
+                written += 16;
+                continue;
+            }
+            // copy the ascii before the first non-ascii byte
+            s32 ascii_count = _bit_scan_forward_u64((u64)non_ascii);
+            for(int i = 0; i < ascii_count; i++) dest[written++] = s.ptr[read++];
+        }
+
+        u32 codepoint = 0;
+        s8 size = unicode_utf8_decode(s.ptr + read, s.size - read, &codepoint);
+        if(size == 0) { ok = false; break; }
+        s32 units = codepoint < 0x10000 ? 1 : 2;
+        if(written + units > dest_size) { ok = false; break; }
+        if(units == 1) dest[written++] = (u16)codepoint;
+        else {
+            codepoint -= 0x10000;
+            dest[written++] = (u16)(0xD800 + (codepoint >> 10));
+            dest[written++] = (u16)(0xDC00 + (codepoint & 0x3FF));
+        }
+        read += size;
+    }
+    if(out_written != NULL) *out_written = written;
+    return ok;
+}
+
+// Converts the str into utf32, writing at most dest_size u32 and filling out_written with how many were written.
+// Returns false (without finishing) if the string is not valid utf8 or dest is not big enough.
+bool str_to_utf32(str s, u32* dest, s32 dest_size, s32* out_written) {
+    ASSERT(dest != NULL || dest_size == 0, "NULL dest buffer given");
+    s32 read = 0;
+    s32 written = 0;
+    bool ok = true;
+    while(read < s.size) {
+        if(read + 16 <= s.size && written + 16 <= dest_size) {
+            __m128i bytes = _mm_loadu_si128((__m128i*)(s.ptr + read));
+            s32 non_ascii = _mm_movemask_epi8(bytes);
+            if(non_ascii == 0) {
+                // 16 ascii characters, simply widen them to u32, 4 at a time
+                _mm_storeu_si128((__m128i*)(dest + written),      _mm_cvtepu8_epi32(bytes));
+                _mm_storeu_si128((__m128i*)(dest + written + 4),  _mm_cvtepu8_epi32(_mm_srli_si128(bytes, 4)));
+                _mm_storeu_si128((__m128i*)(dest + written + 8),  _mm_cvtepu8_epi32(_mm_srli_si128(bytes, 8)));
+                _mm_storeu_si128((__m128i*)(dest + written + 12), _mm_cvtepu8_epi32(_mm_srli_si128(bytes, 12)));
+                read += 16;
+                written += 16;
+                continue;
+            }
+            s32 ascii_count = _bit_scan_forward_u64((u64)non_ascii);
+            for(int i = 0; i < ascii_count; i++) dest[written++] = s.ptr[read++];
+        }
+
+        u32 codepoint = 0;
+        s8 size = unicode_utf8_decode(s.ptr + read, s.size - read, &codepoint);
+        if(size == 0) { ok = false; break; }
+        if(written + 1 > dest_size) { ok = false; break; }
+        dest[written++] = codepoint;
+        read += size;
+    }
+    if(out_written != NULL) *out_written = written;
+    return ok;
+}
+
+// Allocator variants, they return NULL if the string is not valid utf8, else the converted string (of out_size elements)
+u16* str_to_utf16(str s, Allocator alloc, s32* out_size) {
+    if(!str_is_valid_utf8(s)) return NULL;
+    s32 size = str_utf16_length(s);
+    u16* dest = (u16*)mem_alloc(alloc, size * sizeof(u16));
+    str_to_utf16(s, dest, size, out_size);
+    return dest;
+}
+u16* str_to_utf16(str s, s32* out_size) { return str_to_utf16(s, default_allocator, out_size); }
+
+u32* str_to_utf32(str s, Allocator alloc, s32* out_size) {
+    if(!str_is_valid_utf8(s)) return NULL;
+    s32 size = str_utf32_length(s);
+    u32* dest = (u32*)mem_alloc(alloc, size * sizeof(u32));
+    str_to_utf32(s, dest, size, out_size);
+    return dest;
+}
+u32* str_to_utf32(str s, s32* out_size) { return str_to_utf32(s, default_allocator, out_size); }
+
+// how many utf8 bytes are needed to store the given utf16, -1 if it's not valid utf16
+s32 unicode_utf16_to_utf8_length(u16* src, s32 src_size) {
+    s32 length = 0;
+    s32 read = 0;
+    while(read < src_size) {
+        u32 codepoint = 0;
+        s8 units = unicode_utf16_decode(src + read, src_size - read, &codepoint);
+        if(units == 0) return -1;
+        length += unicode_codepoint_to_size(codepoint);
+        read += units;
+    }
+    return length;
+}
+
+// how many utf8 bytes are needed to store the given utf32, -1 if it's not valid utf32
+s32 unicode_utf32_to_utf8_length(u32* src, s32 src_size) {
+    s32 length = 0;
+    for(int i = 0; i < src_size; i++) {
+        u32 codepoint = src[i];
+        if(codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF)) return -1;
+        length += unicode_codepoint_to_size(codepoint);
+    }
+    return length;
+}
+
+// Converts utf16 into a utf8 str inside dest, filling 'out' with the converted portion.
+// Returns false (without finishing) if the input is not valid utf16 or dest is not big enough.
+bool str_from_utf16(u16* src, s32 src_size, u8* dest, s32 dest_size, str* out) {
+    ASSERT(src != NULL || src_size == 0, "NULL src buffer given");
+    s32 read = 0;
+    s32 written = 0;
+    bool ok = true;
+    while(read < src_size) {
+        if(read + 16 <= src_size && written + 16 <= dest_size) {
+            __m128i first  = _mm_loadu_si128((__m128i*)(src + read));
+            __m128i second = _mm_loadu_si128((__m128i*)(src + read + 8));
+            __m128i any_high_bits = _mm_and_si128(_mm_or_si128(first, second), _mm_set1_epi16((s16)0xFF80));
+            if(_mm_testz_si128(any_high_bits, any_high_bits)) {
+                // 16 ascii characters, narrow them down to bytes
+                _mm_storeu_si128((__m128i*)(dest + written), _mm_packus_epi16(first, second));
+                read += 16;
+                written += 16;
+                continue;
+            }
+        }
+
+        u32 codepoint = 0;
+        s8 units = unicode_utf16_decode(src + read, src_size - read, &codepoint);
+        if(units == 0) { ok = false; break; }
+        if(written + unicode_codepoint_to_size(codepoint) > dest_size) { ok = false; break; }
+        written += unicode_codepoint_write_utf8(codepoint, dest + written);
+        read += units;
+    }
+    if(out != NULL) *out = str(dest, written);
+    return ok;
+}
+
+// Converts utf32 into a utf8 str inside dest, filling 'out' with the converted portion.
+// Returns false (without finishing) if the input is not valid utf32 or dest is not big enough.
+bool str_from_utf32(u32* src, s32 src_size, u8* dest, s32 dest_size, str* out) {
+    ASSERT(src != NULL || src_size == 0, "NULL src buffer given");
+    s32 read = 0;
+    s32 written = 0;
+    bool ok = true;
+    while(read < src_size) {
+        if(read + 16 <= src_size && written + 16 <= dest_size) {
+            __m128i v1 = _mm_loadu_si128((__m128i*)(src + read));
+            __m128i v2 = _mm_loadu_si128((__m128i*)(src + read + 4));
+            __m128i v3 = _mm_loadu_si128((__m128i*)(src + read + 8));
+            __m128i v4 = _mm_loadu_si128((__m128i*)(src + read + 12));
+            __m128i all = _mm_or_si128(_mm_or_si128(v1, v2), _mm_or_si128(v3, v4));
+            __m128i any_high_bits = _mm_and_si128(all, _mm_set1_epi32((s32)0xFFFFFF80));
+            if(_mm_testz_si128(any_high_bits, any_high_bits)) {
+                // 16 ascii characters, narrow them down to u16 and then to bytes
+                __m128i low  = _mm_packus_epi32(v1, v2);
+                __m128i high = _mm_packus_epi32(v3, v4);
+                _mm_storeu_si128((__m128i*)(dest + written), _mm_packus_epi16(low, high));
+                read += 16;
+                written += 16;
+                continue;
+            }
+        }
+
+        u32 codepoint = src[read];
+        if(codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF)) { ok = false; break; }
+        if(written + unicode_codepoint_to_size(codepoint) > dest_size) { ok = false; break; }
+        written += unicode_codepoint_write_utf8(codepoint, dest + written);
+        read++;
+    }
+    if(out != NULL) *out = str(dest, written);
+    return ok;
+}
+
+// Allocator variants, they return false (without allocating) if the input is not valid
+bool str_from_utf16(u16* src, s32 src_size, Allocator alloc, str* out) {
+    s32 size = unicode_utf16_to_utf8_length(src, src_size);
+    if(size < 0) return false;
+    return str_from_utf16(src, src_size, (u8*)mem_alloc(alloc, size), size, out);
+}
+bool str_from_utf16(u16* src, s32 src_size, str* out) { return str_from_utf16(src, src_size, default_allocator, out); }
+
+bool str_from_utf32(u32* src, s32 src_size, Allocator alloc, str* out) {
+    s32 size = unicode_utf32_to_utf8_length(src, src_size);
+    if(size < 0) return false;
+    return str_from_utf32(src, src_size, (u8*)mem_alloc(alloc, size), size, out);
+}
+bool str_from_utf32(u32* src, s32 src_size, str* out) { return str_from_utf32(src, src_size, default_allocator, out); }
+
 /*
 StrBuilder, used to dinamically construct str.
 Since str is an array of bytes you can also use this to construct binary data (like files)
+
+For very big outputs (GBs) use make_chunked_str_builder: instead of doubling and copying everything
+each time it runs out of space it links fixed size chunks together, so nothing is ever copied twice.
+Every str_builder_append works the same, but the result is not contiguous, so instead of
+str_builder_get_str you use str_builder_write (writev), str_builder_gather or str_builder_next_chunk.
 */
 
+struct StrBuilderChunk {
+    StrBuilderChunk* next;
+    s32 size; // for the last chunk this is not updated, the real value is StrBuilder.size
+    s32 reserved_size;
+    // the data follows right after
+};
+
 // API(cogno): make this work automatically if make_str_builder is not called.
 struct StrBuilder {
     u8* ptr;
     s32 size;
     s32 reserved_size;
     Allocator alloc;
+
+    // only used in chunked mode, where ptr/size/reserved_size are the ones of the last chunk
+    StrBuilderChunk* first_chunk;
+    StrBuilderChunk* last_chunk;
+    s64 chunked_size; // bytes in every chunk before the last one
+    s32 chunk_size;
+
     u8& operator[](s32 i) { ASSERT_BOUNDS(i, 0, size); return ptr[i]; }
 };
 
+inline bool str_builder_is_chunked(StrBuilder* b) { return b->first_chunk != NULL; }
+inline u8* _str_builder_chunk_data(StrBuilderChunk* chunk) { return (u8*)(chunk + 1); }
+
 // TODO(cogno): make StrBuilder usable when zero initialized
 // TODO(cogno): make StrParser usable when zero initialized
-inline void printsl_custom(StrBuilder b) { for(int i = 0; i < b.size; i++) printsl_custom((char)b.ptr[i]); }
+
+// Iterates over the (contiguous) pieces of the builder, a normal builder has only 1, a chunked one has 1 for each chunk.
+// Start with *iterator = NULL, returns false when there are no more.
+bool str_builder_next_chunk(StrBuilder* b, StrBuilderChunk** iterator, str* out_chunk) {
+    if(!str_builder_is_chunked(b)) {
+        if(*iterator != NULL) return false;
+        *iterator = (StrBuilderChunk*)b; // anything not NULL works, we only need to know we already gave the chunk
+        *out_chunk = str(b->ptr, b->size);
+        return true;
+    }
+    StrBuilderChunk* chunk = *iterator == NULL ? b->first_chunk : (*iterator)->next;
+    if(chunk == NULL) return false;
+    *iterator = chunk;
+    s32 size = chunk == b->last_chunk ? b->size : chunk->size;
+    *out_chunk = str(_str_builder_chunk_data(chunk), size);
+    return true;
+}
+
+inline void printsl_custom(StrBuilder b) {
+    StrBuilderChunk* it = NULL;
+    str chunk;
+    while(str_builder_next_chunk(&b, &it, &chunk)) printsl_custom(chunk);
+}
 
 StrBuilder make_str_builder(s32 size, Allocator alloc) {
     StrBuilder s = {};
@@ -398,17 +877,148 @@ StrBuilder make_str_builder(s32 size, Allocator alloc) {
 StrBuilder make_str_builder() { return make_str_builder(GYO_STR_BUILDER_DEFAULT_SIZE, default_allocator); }
 StrBuilder make_str_builder(s32 size) { return make_str_builder(size, default_allocator); }
 
+// closes the last chunk and starts a new one with at least min_size bytes of space
+void _str_builder_add_chunk(StrBuilder* b, s32 min_size) {
+    s32 size = max(b->chunk_size, min_size);
+    auto* chunk = (StrBuilderChunk*)mem_alloc(b->alloc, sizeof(StrBuilderChunk) + size);
+    chunk->next = NULL;
+    chunk->size = 0;
+    chunk->reserved_size = size;
+    
+    if(b->last_chunk != NULL) {
+        b->last_chunk->size = b->size;
+        b->last_chunk->next = chunk;
+        b->chunked_size += b->size;
+    } else {
+        b->first_chunk = chunk;
+    }
+    b->last_chunk = chunk;
+    b->ptr = _str_builder_chunk_data(chunk);
+    b->size = 0;
+    b->reserved_size = size;
+}
+
+// chunk_size is how big each chunk is, bigger chunks mean less allocations (and less syscalls when writing to a file)
+StrBuilder make_chunked_str_builder(s32 chunk_size, Allocator alloc) {
+    ASSERT_ALWAYS(chunk_size > 0, "invalid chunk size %", chunk_size);
+    StrBuilder s = {};
+    s.alloc = alloc;
+    s.chunk_size = chunk_size;
+    _str_builder_add_chunk(&s, chunk_size);
+    return s;
+}
+StrBuilder make_chunked_str_builder(s32 chunk_size) { return make_chunked_str_builder(chunk_size, default_allocator); }
+StrBuilder make_chunked_str_builder() { return make_chunked_str_builder(GYO_STR_BUILDER_CHUNK_SIZE, default_allocator); }
+
+// total bytes appended, for a normal builder it's the same as b->size
+inline s64 str_builder_total_size(StrBuilder* b) { return b->chunked_size + b->size; }
+
+void _str_builder_free_chunks(StrBuilder* b, StrBuilderChunk* from) {
+    StrBuilderChunk* chunk = from;
+    while(chunk != NULL) {
+        StrBuilderChunk* next = chunk->next;
+        mem_free(b->alloc, chunk, sizeof(StrBuilderChunk) + chunk->reserved_size);
+        chunk = next;
+    }
+}
+
 void str_builder_free(StrBuilder* b) {
-    b->ptr = (u8*)mem_free(b->alloc, b->ptr, b->size);
+    if(str_builder_is_chunked(b)) {
+        _str_builder_free_chunks(b, b->first_chunk);
+        b->first_chunk = b->last_chunk = NULL;
+        b->chunked_size = 0;
+        b->ptr = NULL;
+    } else {
+        b->ptr = (u8*)mem_free(b->alloc, b->ptr, b->size);
+    }
     b->size = b->reserved_size = 0;
 }
 
 void str_builder_clear(StrBuilder* b) {
+    if(str_builder_is_chunked(b)) {
+        // keep only the first chunk, so a cleared builder doesn't hold GBs of memory
+        _str_builder_free_chunks(b, b->first_chunk->next);
+        b->first_chunk->next = NULL;
+        b->last_chunk = b->first_chunk;
+        b->chunked_size = 0;
+        b->ptr = _str_builder_chunk_data(b->first_chunk);
+        b->reserved_size = b->first_chunk->reserved_size;
+    }
     b->size = 0;
 }
 
+// copies every byte of the builder into dest, which must have space for str_builder_total_size(b) bytes
+void str_builder_gather(StrBuilder* b, u8* dest) {
+    StrBuilderChunk* it = NULL;
+    str chunk;
+    while(str_builder_next_chunk(b, &it, &chunk)) {
+        memcpy(dest, chunk.ptr, chunk.size);
+        dest += chunk.size;
+    }
+}
+
+// copies every byte of the builder into a single new str
+str str_builder_gather(StrBuilder* b, Allocator alloc) {
+    s64 total = str_builder_total_size(b);
+    ASSERT_ALWAYS(total <= MAX_S32, "a str can hold at most % bytes, but the builder has %, use str_builder_write or str_builder_next_chunk instead", MAX_S32, total);
+    str s = {};
+    s.ptr = (u8*)mem_alloc(alloc, (s32)total);
+    s.size = (s32)total;
+    str_builder_gather(b, s.ptr);
+    return s;
+}
+str str_builder_gather(StrBuilder* b) { return str_builder_gather(b, default_allocator); }
+
+#ifndef _WIN32
+// Writes every byte of the builder to a file descriptor, giving all the chunks to a single writev
+// (in batches of 64) so they are written without being copied together first.
+// Returns false if a write fails. On windows use win64_write_file instead.
+bool str_builder_write(StrBuilder* b, int fd) {
+    const int max_batch = 64;
+    iovec batch[max_batch];
+    StrBuilderChunk* it = NULL;
+    str chunk;
+    bool chunks_left = true;
+    while(chunks_left) {
+        int count = 0;
+        while(count < max_batch && (chunks_left = str_builder_next_chunk(b, &it, &chunk))) {
+            if(chunk.size == 0) continue;
+            batch[count].iov_base = chunk.ptr;
+            batch[count].iov_len = chunk.size;
+            count++;
+        }
+        
+        // writev can write less than asked (for example with pipes), so we continue from where it stopped
+        iovec* to_write = batch;
+        while(count > 0) {
+            ssize_t written = writev(fd, to_write, count);
+            if(written < 0) return false;
+            while(count > 0 && (size_t)written >= to_write->iov_len) {
+                written -= to_write->iov_len;
+                to_write++;
+                count--;
+            }
+            if(count > 0) {
+                to_write->iov_base = (u8*)to_write->iov_base + written;
+                to_write->iov_len -= written;
+            }
+        }
+    }
+    return true;
+}
+#endif
+
+void str_builder_append(StrBuilder* b, str to_append);
+
 StrBuilder str_builder_copy(StrBuilder* b, Allocator alloc) {
-    StrBuilder copy;
+    StrBuilder copy = {};
+    if(str_builder_is_chunked(b)) {
+        copy = make_chunked_str_builder(b->chunk_size, alloc);
+        StrBuilderChunk* it = NULL;
+        str chunk;
+        while(str_builder_next_chunk(b, &it, &chunk)) str_builder_append(&copy, chunk);
+        return copy;
+    }
     copy.ptr = (u8*)mem_alloc(alloc, b->reserved_size * sizeof(u8));
     copy.size = b->size;
     copy.reserved_size = b->reserved_size;
@@ -419,6 +1029,7 @@ StrBuilder str_builder_copy(StrBuilder* b, Allocator alloc) {
 StrBuilder str_builder_copy(StrBuilder* b) { return str_builder_copy(b, b->alloc); }
 
 str str_builder_get_str(StrBuilder* b) {
+    ASSERT(!str_builder_is_chunked(b), "a chunked StrBuilder is not contiguous, use str_builder_gather or str_builder_next_chunk instead");
     str s = {};
     s.ptr = b->ptr;
     s.size = b->size;
@@ -426,6 +1037,11 @@ str str_builder_get_str(StrBuilder* b) {
 }
 
 void str_builder_resize(StrBuilder* b, s32 min_size) {
+    if(str_builder_is_chunked(b)) {
+        // chunks never move, we just start a new one (big enough for what's left to write)
+        _str_builder_add_chunk(b, min_size - b->size);
+        return;
+    }
     u8 old_start = b->ptr[0];
     s32 new_size = b->reserved_size * 2;
     new_size = max(new_size, GYO_STR_BUILDER_DEFAULT_SIZE);
@@ -441,6 +1057,19 @@ void str_builder_reserve(StrBuilder* b, s32 to_reserve) {
 }
 
 void str_builder_append(StrBuilder* b, str to_append) {
+    if(str_builder_is_chunked(b)) {
+        // fill the last chunk and continue in new ones, splitting the str if needed
+        while(true) {
+            s32 amount = min(b->reserved_size - b->size, to_append.size);
+            memcpy(b->ptr + b->size, to_append.ptr, amount);
+            b->size += amount;
+            to_append.ptr += amount;
+            to_append.size -= amount;
+            if(to_append.size == 0) return;
+            _str_builder_add_chunk(b, 1);
+        }
+    }
+    
     s32 new_size = b->size + to_append.size;
     if(new_size > b->reserved_size) str_builder_resize(b, new_size);
     ASSERT(b->reserved_size >= new_size, "not enough memory allocated, wanted % but allocated %", new_size, b->reserved_size);
@@ -609,12 +1238,7 @@ void str_builder_append(StrBuilder* b, vec4 to_append) {
 // NOTE(cogno): all append_raw are little-endian
 
 void str_builder_append_raw(StrBuilder* b, u8* pointer_to_data, s32 data_size) {
-    str_builder_reserve(b, data_size);
-    ASSERT(b->size + data_size <= b->reserved_size, "out of memory after a reserve??");
-    for(int i = 0; i < data_size; i++) {
-        b->ptr[b->size + i] = pointer_to_data[i];
-    }
-    b->size += data_size;
+    str_builder_append(b, str(pointer_to_data, data_size)); // bytes are bytes, so it's the same as appending a str (and it can be split between chunks)
 }
 
 void str_builder_append_raw(StrBuilder* b, u8 to_add) {
@@ -656,14 +1280,48 @@ void str_builder_append_raw(StrBuilder* b, vec4 to_add) {
 // API(cogno): str builder append raw mat4, col etc.
 #endif
 
+// Variable length integers (LEB128): 7 bits per byte, the high bit tells if more bytes follow,
+// so small numbers take less space (0..127 is 1 byte), a u64 takes at most 10 bytes.
+// Zigzag maps small negative numbers to small positive ones (0, -1, 1, -2 -> 0, 1, 2, 3) so they stay small too.
+inline u64 zigzag_encode(s64 value) { return ((u64)value << 1) ^ (u64)(value >> 63); }
+inline s64 zigzag_decode(u64 value) { return (s64)(value >> 1) ^ -(s64)(value & 1); }
+
+inline s32 varint_size(u64 value) {
+    s32 size = 1;
+    while(value >= 0x80) { value >>= 7; size++; }
+    return size;
+}
+
+// writes value as LEB128 in dest (which must have space for 10 bytes), returns how many bytes were written
+inline s32 varint_write(u8* dest, u64 value) {
+    s32 size = 0;
+    while(value >= 0x80) {
+        dest[size++] = (u8)value | 0x80;
+        value >>= 7;
+    }
+    dest[size++] = (u8)value;
+    return size;
+}
+
+void str_builder_append_varint(StrBuilder* b, u64 to_add) {
+    u8 buff[10];
+    s32 size = varint_write(buff, to_add);
+    str_builder_append_raw(b, buff, size);
+}
+void str_builder_append_zigzag(StrBuilder* b, s64 to_add) { str_builder_append_varint(b, zigzag_encode(to_add)); }
+
 // API(cogno): string builder insert at index
 // API(cogno): string builder replace
 
-void str_builder_remove_last_bytes(StrBuilder* b, s32 bytes_to_remove) { b->size -= bytes_to_remove; }
+void str_builder_remove_last_bytes(StrBuilder* b, s32 bytes_to_remove) {
+    ASSERT(bytes_to_remove <= b->size, "cannot remove % bytes, only % are available (in a chunked builder you can only remove from the last chunk)", bytes_to_remove, b->size);
+    b->size -= bytes_to_remove;
+}
 
 // counts how many bytes are right of the last <to_find> character in the string,
 // returns -1 if <to_find> is not found
 int str_builder_count_right(StrBuilder* b, u8 to_find) {
+    ASSERT(!str_builder_is_chunked(b), "str_builder_count_right only works on normal (contiguous) StrBuilders");
     for(int i = b->size - 1; i >= 0; i--) {
         if(b->ptr[i] == to_find) return b->size - i - 1;
     }
@@ -794,6 +1452,29 @@ T str_parser_get(StrParser* p) {
     return out;
 }
 
+// reads a LEB128 varint (see str_builder_append_varint), returns false if it's truncated or too big for a u64
+bool str_parser_get_varint(StrParser* p, u64* out) {
+    u64 result = 0;
+    for(int i = 0; i < 10 && i < p->size; i++) {
+        u8 byte = p->ptr[i];
+        result |= (u64)(byte & 0x7F) << (7 * i);
+        if(byte < 0x80) {
+            if(i == 9 && byte > 1) return false; // more than 64 bits
+            str_parser_advance(p, i + 1);
+            if(out != NULL) *out = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool str_parser_get_zigzag(StrParser* p, s64* out) {
+    u64 encoded;
+    if(!str_parser_get_varint(p, &encoded)) return false;
+    if(out != NULL) *out = zigzag_decode(encoded);
+    return true;
+}
+
 // NOTE(cogno): each _parse function returns a boolean if it was parsed correctly and optionally fills the given pointer with the parsed value
 // this means that each _parse function can be also used to consume an unwanted value
 
@@ -812,11 +1493,73 @@ bool str_parser_parse_bool(StrParser* p, bool* out) {
     return false;
 }
 
+//
+// SWAR (simd within a register) helpers used to parse numbers 8 bytes at a time.
+// Each u64 is treated as 8 little-endian bytes, the first char of the text is the lowest byte.
+//
+
+inline u64 _swar_load_u64(u8* ptr) {
+    u64 chunk;
+    memcpy(&chunk, ptr, sizeof(chunk)); // compiles to a single unaligned load
+    return chunk;
+}
+
+// how many of the first bytes of the chunk are ascii digits (from 0 to 8)
+inline s32 _swar_count_leading_digits(u64 chunk) {
+    // a byte is a digit if its high nibble is 3 and it stays 3 after adding 6 (so the low nibble is 0-9).
+    // carries between bytes can only come out of a non-digit byte, which means they only
+    // pollute bytes *after* the first non-digit, which we don't care about.
+    u64 high_nibbles       = chunk & 0xF0F0F0F0F0F0F0F0;
+    u64 high_nibbles_plus6 = (chunk + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0;
+    u64 not_digits = (high_nibbles | (high_nibbles_plus6 >> 4)) ^ 0x3333333333333333; // 0 for each digit
+
+    // set the high bit of every non-zero byte (aka every non-digit)
+    u64 not_digits_mask = (((not_digits & 0x7F7F7F7F7F7F7F7F) + 0x7F7F7F7F7F7F7F7F) | not_digits) & 0x8080808080808080;
+    if(not_digits_mask == 0) return 8;
+    return _bit_scan_forward_u64(not_digits_mask) / 8;
+}
+
+// converts the first 'digit_count' ascii digits of the chunk (from 1 to 8) into their value, with 3 multiplications instead of 8
+inline u64 _swar_digits_to_u64(u64 chunk, s32 digit_count) {
+    ASSERT(digit_count > 0 && digit_count <= 8, "can only convert between 1 and 8 digits, % given", digit_count);
+    chunk -= 0x3030303030303030;
+    chunk <<= (8 - digit_count) * 8; // push unwanted bytes out, the zeros that come in act as leading zeros
+    chunk = (chunk * 10)    + (chunk >> 8);  chunk &= 0x00FF00FF00FF00FF; // 8 digits -> 4 values of 2 digits
+    chunk = (chunk * 100)   + (chunk >> 16); chunk &= 0x0000FFFF0000FFFF; // 4 values -> 2 values of 4 digits
+    chunk = (chunk * 10000) + (chunk >> 32); chunk &= 0x00000000FFFFFFFF; // 2 values -> 1 value of 8 digits
+    return chunk;
+}
+
+const u64 _POWERS_OF_10[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+
 bool str_parser_parse_u64(StrParser* p, u64* out) {
     if(!str_parser_starts_with_positive_number(p)) return false;
     str_parser_maybe_consume(p, '+'); // we can ignore it
 
+    // PERF: instead of 1 digit (and 1 division for the overflow check) per iteration, we find
+    // and convert up to 8 digits at a time. Only the end of the parser falls back to 1 digit at a time,
+    // since we can't read 8 bytes past the end of the string.
     u64 tmp = 0;
+    s32 digits_parsed = 0;
+    while(p->size >= 8) {
+        u64 chunk = _swar_load_u64(p->ptr);
+        s32 digit_count = _swar_count_leading_digits(chunk);
+        if(digit_count == 0) break;
+
+        u64 value = _swar_digits_to_u64(chunk, digit_count);
+        u64 multiplier = _POWERS_OF_10[digit_count];
+        digits_parsed += digit_count;
+        // a u64 can always hold 19 digits, only past that we need to check for overflows
+        if(digits_parsed > 19 && tmp > (MAX_U64 - value) / multiplier) return false; // overflow!
+        tmp = tmp * multiplier + value;
+        str_parser_advance(p, digit_count);
+
+        if(digit_count < 8) {
+            if(out != NULL) *out = tmp;
+            return true; // the number ended inside this chunk
+        }
+    }
+
     while(true) {
         if(!str_parser_starts_with_digit(p)) break;
         u8 digit = str_parser_get<u8>(p) - '0';
@@ -905,9 +1648,153 @@ bool str_parser_parse_s8(StrParser* p, s8* out) {
     return true;
 }
 
+// reads consecutive digits into mantissa as long as it fits (19 digits), 8 at a time with SWAR.
+// Returns how many digits were read, kept tells how many went into the mantissa, truncated if some didn't fit.
+inline s32 _str_parser_accumulate_digits(StrParser* p, u64* mantissa, s32* kept, bool* truncated) {
+    s32 read = 0;
+    while(p->size >= 8 && *kept + 8 <= 19) {
+        u64 chunk = _swar_load_u64(p->ptr);
+        s32 digit_count = _swar_count_leading_digits(chunk);
+        if(digit_count == 0) return read;
+        *mantissa = *mantissa * _POWERS_OF_10[digit_count] + _swar_digits_to_u64(chunk, digit_count);
+        *kept += digit_count;
+        read += digit_count;
+        str_parser_advance(p, digit_count);
+        if(digit_count < 8) return read;
+    }
+    while(str_parser_starts_with_digit(p)) {
+        u8 digit = p->ptr[0] - '0';
+        if(*kept < 19) {
+            *mantissa = *mantissa * 10 + digit;
+            *kept += 1;
+        } else *truncated = true;
+        read++;
+        str_parser_advance(p, 1);
+    }
+    return read;
+}
+
+const f64 _F64_POWERS_OF_10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+// Parses numbers like 12, -3.5, 1e10, 6.02E+23 (no inf/nan).
+// PERF: the digits are parsed with the same SWAR helpers as the integers. If the mantissa fits 53 bits and the exponent
+// is small (which is almost always the case) the result is exact with a single multiplication/division (Clinger's fast path),
+// only the others go through strtod.
+bool str_parser_parse_f64(StrParser* p, f64* out) {
+    StrParser start = *p;
+    bool negative = false;
+    if(str_parser_starts_with(p, '-') || str_parser_starts_with(p, '+')) {
+        negative = p->ptr[0] == '-';
+        str_parser_advance(p, 1);
+    }
+
+    u64 mantissa = 0;
+    s32 kept = 0;
+    bool truncated = false;
+    s32 integer_digits = _str_parser_accumulate_digits(p, &mantissa, &kept, &truncated);
+    s32 exponent = integer_digits - kept; // integer digits that didn't fit still count
+    s32 fraction_digits = 0;
+    if(str_parser_starts_with(p, '.')) {
+        str_parser_advance(p, 1);
+        s32 kept_before = kept;
+        fraction_digits = _str_parser_accumulate_digits(p, &mantissa, &kept, &truncated);
+        exponent -= kept - kept_before;
+    }
+    if(integer_digits + fraction_digits == 0) {
+        *p = start; // not a number
+        return false;
+    }
+
+    if(str_parser_starts_with(p, 'e') || str_parser_starts_with(p, 'E')) {
+        StrParser before_exponent = *p;
+        str_parser_advance(p, 1);
+        bool negative_exponent = false;
+        if(str_parser_starts_with(p, '-') || str_parser_starts_with(p, '+')) {
+            negative_exponent = p->ptr[0] == '-';
+            str_parser_advance(p, 1);
+        }
+        if(!str_parser_starts_with_digit(p)) *p = before_exponent; // like "1e", the 'e' is not ours
+        s32 explicit_exponent = 0;
+        while(str_parser_starts_with_digit(p)) {
+            if(explicit_exponent < 100000) explicit_exponent = explicit_exponent * 10 + (p->ptr[0] - '0'); // way past what a f64 can hold
+            str_parser_advance(p, 1);
+        }
+        exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+    }
+
+    f64 value;
+    if(!truncated && mantissa <= (1ull << 53) && exponent >= -22 && exponent <= 22) {
+        // both the mantissa and the power of 10 are exact f64, so a single operation rounds correctly
+        value = (f64)mantissa;
+        if(exponent < 0) value /= _F64_POWERS_OF_10[-exponent];
+        else             value *= _F64_POWERS_OF_10[exponent];
+        if(negative) value = -value;
+    } else {
+        // slow path, strtod needs a null terminated copy
+        s32 size = (s32)(p->ptr - start.ptr);
+        char small_buffer[64];
+        char* buffer = size < (s32)sizeof(small_buffer) ? small_buffer : (char*)malloc(size + 1);
+        memcpy(buffer, start.ptr, size);
+        buffer[size] = 0;
+        value = strtod(buffer, NULL);
+        if(buffer != small_buffer) free(buffer);
+    }
+    if(out != NULL) *out = value;
+    return true;
+}
+
+bool str_parser_parse_f32(StrParser* p, f32* out) {
+    f64 value;
+    if(!str_parser_parse_f64(p, &value)) return false;
+    if(out != NULL) *out = (f32)value;
+    return true;
+}
+
+// Parses a list of positive numbers separated by a delimiter (like "12,5,300") in a single call.
+// Fills at most out_size values and returns how many it parsed. Parsing stops at the first
+// element that is not a number, or when there's no delimiter after the last number parsed.
+// The parser is left right after the last number parsed, so you can check what stopped it
+// (with "1,2,x" it stops on the ',' before the x).
+// Example:
+// u64 values[10];
+// s32 count = str_parser_parse_u64_array(&parser, ',', values, 10);
+s32 str_parser_parse_u64_array(StrParser* p, u8 delimiter, u64* out, s32 out_size) {
+    ASSERT(out != NULL, "invalid output buffer given (was NULL)");
+    s32 count = 0;
+    StrParser next = *p;
+    while(count < out_size) {
+        if(count > 0) {
+            if(!str_parser_starts_with(&next, delimiter)) break;
+            str_parser_advance(&next, 1);
+        }
+        if(!str_parser_parse_u64(&next, &out[count])) break;
+        *p = next; // the delimiter is consumed only once the number after it is parsed
+        count++;
+    }
+    return count;
+}
+
+#ifdef GYO_ARRAY
+// Array variant of str_parser_parse_u64_array, appends every number parsed and returns how many were appended.
+s32 str_parser_parse_u64_array(StrParser* p, u8 delimiter, Array<u64>* out) {
+    ASSERT(out != NULL, "invalid output array given (was NULL)");
+    s32 count = 0;
+    u64 value = 0;
+    StrParser next = *p;
+    while(true) {
+        if(count > 0) {
+            if(!str_parser_starts_with(&next, delimiter)) break;
+            str_parser_advance(&next, 1);
+        }
+        if(!str_parser_parse_u64(&next, &value)) break;
+        *p = next;
+        array_append(out, value);
+        count++;
+    }
+    return count;
+}
+#endif
 
 // parse functions convert str to types and return them
-// API(cogno): parse f32
-// API(cogno): parse f64
 
 
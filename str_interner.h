@@ -0,0 +1,147 @@
+#pragma once
+#define GYO_STR_INTERNER
+
+/*
+In this file:
+- StrInterner, a table of unique strings. Each string you intern is stored only once, and you get back
+  an id (u32) and a str that will never move. Two interned strings are equal if and only if their ids
+  (or their ptr) are equal, so you can compare them with a single integer compare instead of str_matches.
+  It's safe to intern from multiple threads at the same time.
+
+Example:
+StrInterner interner = make_str_interner(10000);
+defer { str_interner_free(&interner); };
+u32 a = str_intern(&interner, "hello");
+u32 b = str_intern(&interner, some_str_read_from_a_file);
+if(a == b) { ... }                 // same as str_matches, but way faster
+str hello = str_interned(&interner, a);
+*/
+
+#ifndef GYOFIRST
+    #include "first.h"
+#endif
+
+#ifndef GYO_ALLOCATORS
+    #include "allocators.h"
+#endif
+
+#ifndef GYO_ARRAY
+    #include "array.h"
+#endif
+
+#ifndef GYO_STR
+    #include "str.h"
+#endif
+
+#ifndef GYO_HASHMAP
+    #include "hashmap.h"
+#endif
+
+#ifndef GYO_THREADS
+    #include "threads.h"
+#endif
+
+// The interner is split in shards, each with its own lock, so threads interning different strings rarely wait for each other.
+// The shard is part of the id, so an id can go up to (4 billion / shards) strings per shard.
+#define GYO_STR_INTERNER_SHARD_BITS 4
+#define GYO_STR_INTERNER_SHARDS (1 << GYO_STR_INTERNER_SHARD_BITS)
+#define GYO_STR_INTERNER_ARENA_SIZE (64 * 1024)
+
+struct alignas(64) StrInternerShard { // aligned so 2 shards never share a cache line (and their locks don't fight)
+    SpinLock lock;
+    HashMap<str, u32> ids; // string -> index inside strings
+    Array<str> strings;    // index -> string (inside arena)
+    Arena arena;           // where the bytes of each string live, contiguously
+};
+
+struct StrInterner {
+    StrInternerShard shards[GYO_STR_INTERNER_SHARDS];
+};
+
+// expected_strings is used to size the hashmaps, it's not a limit, but the closer it is the faster interning gets
+StrInterner make_str_interner(s32 expected_strings, Allocator alloc) {
+    StrInterner interner = {};
+    s32 per_shard = expected_strings / GYO_STR_INTERNER_SHARDS + 1;
+    for(int i = 0; i < GYO_STR_INTERNER_SHARDS; i++) {
+        StrInternerShard* shard = &interner.shards[i];
+        shard->ids = make_hashmap<str, u32>(per_shard, alloc);
+        shard->strings = make_array<str>(per_shard, alloc);
+        shard->arena = make_arena_allocator(GYO_STR_INTERNER_ARENA_SIZE);
+    }
+    return interner;
+}
+StrInterner make_str_interner(s32 expected_strings) { return make_str_interner(expected_strings, default_allocator); }
+
+void str_interner_free(StrInterner* interner) {
+    for(int i = 0; i < GYO_STR_INTERNER_SHARDS; i++) {
+        StrInternerShard* shard = &interner->shards[i];
+        map_free(&shard->ids);
+        array_free(&shard->strings);
+        mem_free_all(&shard->arena);
+    }
+}
+
+inline StrInternerShard* _str_interner_get_shard(StrInterner* interner, str s) {
+    // NOTE: we use the high bits of the hash, the hashmap uses (hash % size) which mostly depends on the low ones.
+    // If we used the low bits too every string in a shard would end up in the same few buckets.
+    u64 hash = hash_default(&s, sizeof(s));
+    return &interner->shards[(hash >> 32) % GYO_STR_INTERNER_SHARDS];
+}
+
+inline u32 _str_interner_make_id(StrInterner* interner, StrInternerShard* shard, u32 index) {
+    u32 shard_index = (u32)(shard - interner->shards);
+    ASSERT_ALWAYS(index < (MAX_U32 >> GYO_STR_INTERNER_SHARD_BITS), "too many strings interned, the ids don't fit in a u32 anymore");
+    return (index << GYO_STR_INTERNER_SHARD_BITS) | shard_index;
+}
+
+// Returns the id of the string, copying it into the interner if it's the first time we see it.
+// out_interned (optional) is filled with the interned copy, which never moves until str_interner_free.
+u32 str_intern(StrInterner* interner, str s, str* out_interned) {
+    StrInternerShard* shard = _str_interner_get_shard(interner, s);
+    spin_lock(&shard->lock);
+    defer { spin_unlock(&shard->lock); };
+
+    u32 index = 0;
+    if(!map_find(&shard->ids, s, &index)) {
+        // first time we see it, copy it in the arena so it doesn't depend on the memory of the caller
+        str copy = str((u8*)mem_alloc(&shard->arena, s.size), s.size);
+        memcpy(copy.ptr, s.ptr, s.size);
+        index = array_append(&shard->strings, copy);
+        map_insert(&shard->ids, copy, index);
+    }
+    if(out_interned != NULL) *out_interned = shard->strings[index];
+    return _str_interner_make_id(interner, shard, index);
+}
+u32 str_intern(StrInterner* interner, str s) { return str_intern(interner, s, NULL); }
+
+// Returns true (and optionally the id) if the string was already interned, never adds it.
+bool str_interner_find(StrInterner* interner, str s, u32* out_id) {
+    StrInternerShard* shard = _str_interner_get_shard(interner, s);
+    spin_lock(&shard->lock);
+    defer { spin_unlock(&shard->lock); };
+
+    u32 index = 0;
+    if(!map_find(&shard->ids, s, &index)) return false;
+    if(out_id != NULL) *out_id = _str_interner_make_id(interner, shard, index);
+    return true;
+}
+
+// gives back the string of an id returned by str_intern
+str str_interned(StrInterner* interner, u32 id) {
+    StrInternerShard* shard = &interner->shards[id & (GYO_STR_INTERNER_SHARDS - 1)];
+    spin_lock(&shard->lock); // another thread might be growing the array
+    defer { spin_unlock(&shard->lock); };
+    return shard->strings[id >> GYO_STR_INTERNER_SHARD_BITS];
+}
+
+// how many unique strings have been interned
+s32 str_interner_count(StrInterner* interner) {
+    s32 count = 0;
+    for(int i = 0; i < GYO_STR_INTERNER_SHARDS; i++) {
+        StrInternerShard* shard = &interner->shards[i];
+        spin_lock(&shard->lock);
+        count += shard->strings.size;
+        spin_unlock(&shard->lock);
+    }
+    return count;
+}
@@ -0,0 +1,250 @@
+#pragma once
+#define GYO_STR_TOKENIZER
+
+/*
+In this file:
+- StrTokenizer, a streaming way to split input into lines or (csv) fields, when the input comes in chunks.
+  Useful to parse files of many GB in fixed memory, you read a chunk, feed it, take all the tokens you can and repeat.
+
+USAGE:
+StrTokenizer t = make_csv_tokenizer(',');  // or make_line_tokenizer()
+defer { str_tokenizer_free(&t); };
+while(read_next_chunk(&chunk)) {
+    str_tokenizer_feed(&t, chunk);
+    str field; bool end_of_line;
+    while(str_tokenizer_next(&t, &field, &end_of_line)) { ... }
+}
+str_tokenizer_finish(&t); // no more chunks, gives you the last token (if any)
+while(str_tokenizer_next(&t, &field, &end_of_line)) { ... }
+
+Tokens point directly inside the chunk you gave (no copies). Only tokens split between 2 chunks
+and quoted csv fields get copied in a small buffer owned by the tokenizer (which only grows to the size of the biggest token).
+Tokens are valid until the next call to str_tokenizer_next or str_tokenizer_feed, and chunks must stay valid until the next feed.
+*/
+
+#ifndef GYOFIRST
+    #include "first.h"
+#endif
+
+#ifndef GYO_STR
+    #include "str.h"
+#endif
+
+#define GYO_STR_TOKENIZER_DEFAULT_SIZE 256
+
+struct StrTokenizer {
+    StrParser parser;   // what's left to tokenize of the current chunk
+    StrBuilder carry;   // token we started in a previous chunk (or quoted field being unescaped)
+    u8 delimiter;       // ',' for fields, '\n' for lines
+    u8 quote;           // 0 if quotes are not handled
+
+    // bitmask of where delimiters, newlines and quotes are in the 64 bytes starting at mask_ptr,
+    // so we can jump from one to the other instead of checking 1 byte at a time.
+    u8* mask_ptr;
+    u64 mask;
+
+    bool finished;        // no more chunks will come
+    bool carry_returned;  // the last token returned was inside carry, clear it before the next one
+    bool field_pending;   // there's a field still to give back (after a delimiter there's always one, even if empty)
+    bool in_quotes;       // we're inside a quoted field
+    bool quote_pending;   // the chunk ended with a quote inside a quoted field, we need the next byte to know if it was an escaped "" or the end of the field
+    s32 quoted_size;      // how many bytes at the start of carry came from inside quotes (a '\r' there is part of the field)
+};
+
+StrTokenizer make_str_tokenizer(u8 delimiter, u8 quote, Allocator alloc) {
+    StrTokenizer t = {};
+    t.carry = make_str_builder(GYO_STR_TOKENIZER_DEFAULT_SIZE, alloc);
+    t.delimiter = delimiter;
+    t.quote = quote;
+    return t;
+}
+
+// splits on '\n' (removing '\r' if present)
+StrTokenizer make_line_tokenizer(Allocator alloc) { return make_str_tokenizer('\n', 0, alloc); }
+StrTokenizer make_line_tokenizer() { return make_line_tokenizer(default_allocator); }
+
+// splits on the delimiter and on newlines, handling csv quoted fields ("a,b" is a single field, "" inside quotes is a ")
+StrTokenizer make_csv_tokenizer(u8 delimiter, Allocator alloc) { return make_str_tokenizer(delimiter, '"', alloc); }
+StrTokenizer make_csv_tokenizer(u8 delimiter) { return make_csv_tokenizer(delimiter, default_allocator); }
+
+void str_tokenizer_free(StrTokenizer* t) { str_builder_free(&t->carry); }
+
+// gives the next chunk of input to the tokenizer, everything in the previous chunk must have been already taken with str_tokenizer_next
+void str_tokenizer_feed(StrTokenizer* t, str chunk) {
+    ASSERT(!t->finished, "cannot feed a tokenizer after calling str_tokenizer_finish");
+    ASSERT(str_parser_is_empty(&t->parser), "feeding a new chunk before taking every token in the previous one, % bytes would be lost", t->parser.size);
+    t->parser = make_str_parser(chunk);
+    t->mask_ptr = NULL; // the new chunk might be in the same buffer as the old one, the mask is not valid anymore
+}
+
+// tells the tokenizer no more chunks will come, so str_tokenizer_next can give back the last token
+void str_tokenizer_finish(StrTokenizer* t) { t->finished = true; }
+
+// bitmask of every structural character (delimiters, newlines and quotes) in the 64 bytes starting at ptr
+inline u64 _str_tokenizer_compute_mask(StrTokenizer* t, u8* ptr) {
+    __m128i delimiters = _mm_set1_epi8(t->delimiter);
+    __m128i newlines   = _mm_set1_epi8('\n');
+    __m128i quotes     = _mm_set1_epi8(t->quote); // if quotes are disabled this checks for 0, which we filter out below
+    u64 mask = 0;
+    for(int i = 0; i < 4; i++) {
+        __m128i bytes = _mm_loadu_si128((__m128i*)(ptr + 16 * i));
+        __m128i found = _mm_or_si128(_mm_cmpeq_epi8(bytes, delimiters), _mm_cmpeq_epi8(bytes, newlines));
+        if(t->quote != 0) found = _mm_or_si128(found, _mm_cmpeq_epi8(bytes, quotes));
+        mask |= (u64)(u32)_mm_movemask_epi8(found) << (16 * i);
+    }
+    return mask;
+}
+
+inline bool _str_tokenizer_is_structural(StrTokenizer* t, u8 ch) {
+    return ch == t->delimiter || ch == '\n' || (t->quote != 0 && ch == t->quote);
+}
+
+// index (in the parser) of the next structural character from 'from' onwards, -1 if there's none in this chunk
+s32 _str_tokenizer_find_structural(StrTokenizer* t, s32 from) {
+    u8* start = t->parser.ptr;
+    u8* end = start + t->parser.size;
+    u8* cursor = start + from;
+    while(cursor < end) {
+        bool inside_mask = t->mask_ptr != NULL && cursor >= t->mask_ptr && cursor < t->mask_ptr + 64;
+        if(!inside_mask) {
+            if(end - cursor < 64) {
+                // not enough bytes to read a full mask, finish byte by byte
+                for(; cursor < end; cursor++) {
+                    if(_str_tokenizer_is_structural(t, *cursor)) return (s32)(cursor - start);
+                }
+                return -1;
+            }
+            t->mask_ptr = cursor;
+            t->mask = _str_tokenizer_compute_mask(t, cursor);
+        }
+
+        u64 bits = t->mask >> (cursor - t->mask_ptr);
+        if(bits != 0) return (s32)(cursor - start) + _bit_scan_forward_u64(bits);
+        cursor = t->mask_ptr + 64;
+    }
+    return -1;
+}
+
+// moves the first 'size' bytes of the parser into carry
+inline void _str_tokenizer_move_to_carry(StrTokenizer* t, s32 size) {
+    str_builder_append(&t->carry, str(t->parser.ptr, size));
+    str_parser_advance(&t->parser, size);
+}
+
+inline void _str_tokenizer_close_quotes(StrTokenizer* t) {
+    t->in_quotes = false;
+    t->quote_pending = false;
+    t->quoted_size = t->carry.size;
+}
+
+// Reads inside a quoted field, copying its (unescaped) content into carry.
+// Returns true when the closing quote is found, false if the chunk ended before it.
+bool _str_tokenizer_read_quoted(StrTokenizer* t) {
+    if(t->quote_pending) {
+        // last chunk ended with a quote, now we can know what it was
+        if(str_parser_is_empty(&t->parser)) {
+            if(!t->finished) return false;
+            _str_tokenizer_close_quotes(t); // input is over, it was a closing quote
+            return true;
+        }
+        t->quote_pending = false;
+        if(str_parser_starts_with(&t->parser, t->quote)) {
+            str_builder_append(&t->carry, (char)t->quote); // escaped quote ("")
+            str_parser_advance(&t->parser, 1);
+        } else {
+            _str_tokenizer_close_quotes(t);
+            return true;
+        }
+    }
+
+    s32 from = 0;
+    while(true) {
+        s32 index = _str_tokenizer_find_structural(t, from);
+        if(index < 0) {
+            // the field continues in the next chunk
+            _str_tokenizer_move_to_carry(t, t->parser.size);
+            if(t->finished) _str_tokenizer_close_quotes(t); // the quote never closed, keep what we've got
+            return t->finished;
+        }
+        if(t->parser.ptr[index] != t->quote) { from = index + 1; continue; } // delimiters inside quotes are just text
+
+        _str_tokenizer_move_to_carry(t, index);
+        if(t->parser.size < 2) {
+            // quote at the end of the chunk, we can't know yet if it's escaped or closing
+            str_parser_advance(&t->parser, 1);
+            t->quote_pending = true;
+            if(t->finished) { _str_tokenizer_close_quotes(t); return true; }
+            return false;
+        }
+        if(t->parser.ptr[1] == t->quote) {
+            // escaped quote (""), keep only one
+            str_builder_append(&t->carry, (char)t->quote);
+            str_parser_advance(&t->parser, 2);
+            from = 0;
+            continue;
+        }
+
+        str_parser_advance(&t->parser, 1); // closing quote
+        _str_tokenizer_close_quotes(t);
+        return true;
+    }
+}
+
+// Takes the next token, returns false if there are no more tokens (either you need to feed the next
+// chunk or, after str_tokenizer_finish, the input is over).
+// out_end_of_record (optional) is set to true if the token was the last of its line.
+bool str_tokenizer_next(StrTokenizer* t, str* out_token, bool* out_end_of_record) {
+    if(t->carry_returned) {
+        str_builder_clear(&t->carry);
+        t->carry_returned = false;
+        t->quoted_size = 0;
+    }
+
+    // quoted fields are always unescaped into carry
+    bool at_field_start = t->carry.size == 0;
+    if(t->in_quotes || (t->quote != 0 && at_field_start && str_parser_starts_with(&t->parser, t->quote))) {
+        if(!t->in_quotes) {
+            str_parser_advance(&t->parser, 1); // opening quote
+            t->in_quotes = true;
+            t->field_pending = true;
+        }
+        if(!_str_tokenizer_read_quoted(t)) return false;
+    }
+
+    s32 index = _str_tokenizer_find_structural(t, 0);
+    while(index >= 0 && t->quote != 0 && t->parser.ptr[index] == t->quote) index = _str_tokenizer_find_structural(t, index + 1); // quotes in the middle of a field are just text
+
+    if(index < 0) {
+        // no end of the token in this chunk, save what we have for the next one
+        if(t->parser.size > 0) t->field_pending = true;
+        _str_tokenizer_move_to_carry(t, t->parser.size);
+        if(!t->finished || !t->field_pending) return false;
+
+        // input is over, what's left is the last token
+        t->field_pending = false;
+        t->carry_returned = true;
+        str token = str_builder_get_str(&t->carry);
+        if(token.size > t->quoted_size && str_ends_with(token, '\r')) token.size--;
+        if(out_token != NULL) *out_token = token;
+        if(out_end_of_record != NULL) *out_end_of_record = true;
+        return true;
+    }
+
+    u8 terminator = t->parser.ptr[index];
+    str token = str(t->parser.ptr, index);
+    if(t->carry.size > 0) {
+        // the token started in a previous chunk (or was quoted), complete it in carry
+        str_builder_append(&t->carry, token);
+        token = str_builder_get_str(&t->carry);
+        t->carry_returned = true;
+    }
+    str_parser_advance(&t->parser, index + 1);
+
+    bool end_of_record = terminator == '\n';
+    if(end_of_record && token.size > t->quoted_size && str_ends_with(token, '\r')) token.size--; // same as str_split_newline_left, \r\n counts as a single newline
+    t->field_pending = !end_of_record; // after a delimiter there's always another field, even if empty
+
+    if(out_token != NULL) *out_token = token;
+    if(out_end_of_record != NULL) *out_end_of_record = end_of_record;
+    return true;
+}
@@ -0,0 +1,332 @@
+#pragma once
+#define GYO_THREAD_POOL
+
+/*
+In this file:
+- ThreadPool, a work-stealing thread pool. Each worker has its own deque (Chase-Lev) of work: it takes work from the
+  bottom of its own and, when it runs out, steals from the top of the others, so the load balances itself
+- parallel_range and parallel_range_chunks, to run a function over a range of indices on every core
+- ParallelFor, like For_ptr but in parallel
+- thread_pool_scratch, an Arena for each worker, for temporary allocations without locks
+
+Example:
+ParallelFor(particles, 1024) {
+    it->position += it->velocity * dt; // it is a pointer (like For_ptr), it_index the index
+};  // <- note the ';', the body is a lambda
+
+parallel_range(0, 1000000, [&](s64 i) { out[i] = expensive(in[i]); });
+
+The work is split in halves until a piece is smaller than grain (how many indices are worth sending to another core),
+if you give 0 it's chosen for you. The thread calling a parallel function works too, and only returns when everything is done.
+Calls to parallel functions can be nested, calls from different threads outside the pool run one at a time.
+*/
+
+#ifndef GYOFIRST
+    #include "first.h"
+#endif
+
+#ifndef GYO_ALLOCATORS
+    #include "allocators.h"
+#endif
+
+#ifndef GYO_THREADS
+    #include "threads.h"
+#endif
+
+#define GYO_THREAD_POOL_MAX_THREADS 64
+#define GYO_THREAD_POOL_DEQUE_SIZE 1024 // must be a power of 2, when a deque is full the worker just keeps the work for itself
+#define GYO_THREAD_POOL_SCRATCH_SIZE (1024 * 1024)
+
+typedef void (*ParallelRangeFunction)(s64 begin, s64 end, void* data);
+
+struct _ParallelJob {
+    ParallelRangeFunction function;
+    void* data;
+    s64 grain;
+    volatile s64 remaining; // how many indices still have to be processed
+};
+
+// a piece of a job, the fields are read/written atomically since thieves might read them while the owner writes
+struct _WorkItem {
+    volatile s64 job; // _ParallelJob*
+    volatile s64 begin;
+    volatile s64 end;
+};
+
+struct _WorkDeque {
+    volatile s64 top;    // thieves take from here
+    u8 padding1[56];     // top and bottom on different cache lines, so the owner and the thieves don't fight over them
+    volatile s64 bottom; // the owner pushes and pops here
+    u8 padding2[56];
+    _WorkItem items[GYO_THREAD_POOL_DEQUE_SIZE];
+};
+
+struct ThreadPool;
+
+struct _ThreadPoolWorker {
+    ThreadPool* pool;
+    s32 index;  // which deque/scratch arena it uses
+    s32 depth;  // how many chunks it's running one inside the other (nested parallel calls)
+    u64 random; // to pick who to steal from
+};
+
+struct ThreadPool {
+    s32 thread_count;
+    Thread threads[GYO_THREAD_POOL_MAX_THREADS];
+    _ThreadPoolWorker workers[GYO_THREAD_POOL_MAX_THREADS];
+    _WorkDeque* deques; // thread_count + 1, the last one is used by the thread outside the pool which is calling a parallel function
+    Arena* scratch;     // thread_count + 1, same as deques
+    SpinLock external_lock; // only one thread outside the pool at a time can use the last deque
+    volatile s32 running;
+    volatile s32 active_jobs;
+    Allocator alloc;
+};
+
+thread_local _ThreadPoolWorker _thread_pool_worker = {};
+
+//
+// Chase-Lev deque, see "Dynamic Circular Work-Stealing Deque" (Chase, Lev) and "Correct and Efficient Work-Stealing for Weak Memory Models" (Lê et al.)
+//
+
+inline void _work_deque_read(_WorkDeque* d, s64 index, _WorkItem* out) {
+    _WorkItem* item = &d->items[index & (GYO_THREAD_POOL_DEQUE_SIZE - 1)];
+    out->job   = atomic_load(&item->job);
+    out->begin = atomic_load(&item->begin);
+    out->end   = atomic_load(&item->end);
+}
+
+// only the owner can push
+bool _work_deque_push(_WorkDeque* d, _ParallelJob* job, s64 begin, s64 end) {
+    s64 b = atomic_load(&d->bottom);
+    s64 t = atomic_load(&d->top);
+    if(b - t >= GYO_THREAD_POOL_DEQUE_SIZE) return false; // full
+    _WorkItem* item = &d->items[b & (GYO_THREAD_POOL_DEQUE_SIZE - 1)];
+    atomic_store(&item->job, (s64)job);
+    atomic_store(&item->begin, begin);
+    atomic_store(&item->end, end);
+    atomic_store(&d->bottom, b + 1); // release, a thief seeing the new bottom sees the item too
+    return true;
+}
+
+// only the owner can pop, it takes the last item pushed
+bool _work_deque_pop(_WorkDeque* d, _WorkItem* out) {
+    s64 b = atomic_load(&d->bottom) - 1;
+    atomic_exchange(&d->bottom, b); // full barrier, thieves must see the new bottom before we read top
+    s64 t = atomic_load(&d->top);
+    if(t > b) {
+        atomic_store(&d->bottom, b + 1); // it was empty
+        return false;
+    }
+    _work_deque_read(d, b, out);
+    if(t == b) {
+        // the last item, a thief might be taking it too, whoever moves top first wins
+        bool won = atomic_compare_exchange(&d->top, t, t + 1) == t;
+        atomic_store(&d->bottom, b + 1);
+        return won;
+    }
+    return true;
+}
+
+// anyone can steal, it takes the first item pushed (the biggest piece of work, since we split in halves)
+bool _work_deque_steal(_WorkDeque* d, _WorkItem* out) {
+    s64 t = atomic_load(&d->top);
+    atomic_fence();
+    s64 b = atomic_load(&d->bottom);
+    if(t >= b) return false;
+    _work_deque_read(d, t, out);
+    return atomic_compare_exchange(&d->top, t, t + 1) == t;
+}
+
+//
+// workers
+//
+
+bool _thread_pool_find_work(_ThreadPoolWorker* w, _WorkItem* out) {
+    ThreadPool* pool = w->pool;
+    if(_work_deque_pop(&pool->deques[w->index], out)) return true;
+
+    // nothing left in ours, try to steal from everyone else starting from a random one
+    s32 deque_count = pool->thread_count + 1;
+    w->random ^= w->random << 13; // xorshift
+    w->random ^= w->random >> 7;
+    w->random ^= w->random << 17;
+    s32 first = (s32)(w->random % deque_count);
+    for(s32 i = 0; i < deque_count; i++) {
+        s32 victim = (first + i) % deque_count;
+        if(victim != w->index && _work_deque_steal(&pool->deques[victim], out)) return true;
+    }
+    return false;
+}
+
+void _thread_pool_run(_ThreadPoolWorker* w, _WorkItem* item) {
+    _ParallelJob* job = (_ParallelJob*)item->job;
+    s64 begin = item->begin;
+    s64 end = item->end;
+    // split in halves until what's left is small enough, the upper halves are for whoever wants them
+    while(end - begin > job->grain) {
+        s64 middle = begin + (end - begin) / 2;
+        if(!_work_deque_push(&w->pool->deques[w->index], job, middle, end)) break; // full, we keep it all
+        end = middle;
+    }
+    if(w->depth == 0) arena_reset(&w->pool->scratch[w->index]); // only when nobody's using it
+    w->depth++;
+    job->function(begin, end, job->data);
+    w->depth--;
+    atomic_add(&job->remaining, -(end - begin)); // after this the job might not exist anymore
+}
+
+void _thread_pool_worker_main(void* data) {
+    _ThreadPoolWorker* w = (_ThreadPoolWorker*)data;
+    _thread_pool_worker = *w;
+    ThreadPool* pool = w->pool;
+    s32 idle = 0;
+    while(atomic_load(&pool->running)) {
+        _WorkItem item;
+        if(_thread_pool_find_work(&_thread_pool_worker, &item)) {
+            _thread_pool_run(&_thread_pool_worker, &item);
+            idle = 0;
+            continue;
+        }
+        // nothing to do, the longer it lasts the less cpu we want to use
+        idle++;
+        if(idle < 64) _mm_pause();
+        else if(idle < 1024 || atomic_load(&pool->active_jobs) > 0) thread_yield();
+        else thread_sleep_ms(1);
+    }
+}
+
+// thread_count threads are started, the thread calling parallel functions works too (so cpu count - 1 uses every core)
+ThreadPool* make_thread_pool(s32 thread_count, Allocator alloc) {
+    ASSERT(thread_count >= 0 && thread_count <= GYO_THREAD_POOL_MAX_THREADS, "a thread pool can have from 0 to % threads, % requested", GYO_THREAD_POOL_MAX_THREADS, thread_count);
+    ThreadPool* pool = (ThreadPool*)mem_alloc(alloc, sizeof(ThreadPool)); // the threads keep a pointer to it, so it can't move
+    *pool = {};
+    pool->alloc = alloc;
+    pool->thread_count = thread_count;
+    pool->running = 1;
+    pool->deques = (_WorkDeque*)mem_alloc(alloc, (thread_count + 1) * sizeof(_WorkDeque));
+    pool->scratch = (Arena*)mem_alloc(alloc, (thread_count + 1) * sizeof(Arena));
+    for(s32 i = 0; i < thread_count + 1; i++) {
+        memset(&pool->deques[i], 0, sizeof(_WorkDeque));
+        pool->scratch[i] = make_arena_allocator(GYO_THREAD_POOL_SCRATCH_SIZE);
+    }
+    for(s32 i = 0; i < thread_count; i++) {
+        _ThreadPoolWorker* w = &pool->workers[i];
+        w->pool = pool;
+        w->index = i;
+        w->random = 0x9E3779B97F4A7C15ull * (i + 1);
+        pool->threads[i] = thread_start(_thread_pool_worker_main, w);
+    }
+    return pool;
+}
+ThreadPool* make_thread_pool(s32 thread_count) { return make_thread_pool(thread_count, default_allocator); }
+
+// waits for the threads to finish what they're doing and stops them
+void thread_pool_free(ThreadPool* pool) {
+    atomic_store(&pool->running, 0);
+    for(s32 i = 0; i < pool->thread_count; i++) thread_join(&pool->threads[i]);
+    for(s32 i = 0; i < pool->thread_count + 1; i++) mem_free_all(&pool->scratch[i]);
+    Allocator alloc = pool->alloc;
+    mem_free(alloc, pool->scratch, (pool->thread_count + 1) * sizeof(Arena));
+    mem_free(alloc, pool->deques, (pool->thread_count + 1) * sizeof(_WorkDeque));
+    mem_free(alloc, pool, sizeof(ThreadPool));
+}
+
+volatile s64 _thread_pool_default = 0;
+
+// the pool used when you don't give one, started the first time you need it with a thread for each core (except yours)
+ThreadPool* thread_pool_default() {
+    ThreadPool* pool = (ThreadPool*)atomic_load(&_thread_pool_default);
+    if(pool != NULL) return pool;
+    ThreadPool* created = make_thread_pool(min(max(get_cpu_count() - 1, 0), GYO_THREAD_POOL_MAX_THREADS));
+    if(atomic_compare_exchange(&_thread_pool_default, 0, (s64)created) != 0) thread_pool_free(created); // another thread was faster
+    return (ThreadPool*)atomic_load(&_thread_pool_default);
+}
+
+// an Arena only for the current worker, valid only inside the function you gave to the parallel call.
+// It's reset every time the worker starts a new piece of work, so there's no need to free what you allocate.
+Arena* thread_pool_scratch() {
+    _ThreadPoolWorker* w = &_thread_pool_worker;
+    ASSERT(w->pool != NULL && w->depth > 0, "the scratch arena can only be used inside a parallel function");
+    return &w->pool->scratch[w->index];
+}
+
+//
+// parallel functions
+//
+
+// calls function(begin, end, data) on pieces of [min_index, max_index) on every thread of the pool, returns when they're all done
+void parallel_range_chunks(ThreadPool* pool, s64 min_index, s64 max_index, s64 grain, ParallelRangeFunction function, void* data) {
+    if(max_index <= min_index) return;
+    if(grain <= 0) grain = max((max_index - min_index) / ((pool->thread_count + 1) * 8), (s64)1); // ~8 pieces for each thread, so stealing can balance them
+
+    _ThreadPoolWorker saved = _thread_pool_worker;
+    bool is_external = saved.pool != pool;
+    if(is_external) {
+        // we're not one of the pool's threads, so we use the extra deque (one caller at a time)
+        while(!spin_try_lock(&pool->external_lock)) thread_yield();
+        _thread_pool_worker = {};
+        _thread_pool_worker.pool = pool;
+        _thread_pool_worker.index = pool->thread_count;
+        _thread_pool_worker.random = (u64)&saved | 1;
+    }
+    atomic_add(&pool->active_jobs, 1);
+
+    _ParallelJob job = {};
+    job.function = function;
+    job.data = data;
+    job.grain = grain;
+    job.remaining = max_index - min_index;
+    _WorkItem first = {};
+    first.job = (s64)&job;
+    first.begin = min_index;
+    first.end = max_index;
+    _thread_pool_run(&_thread_pool_worker, &first);
+
+    // help with whatever is left until everything is done
+    while(atomic_load(&job.remaining) > 0) {
+        _WorkItem item;
+        if(_thread_pool_find_work(&_thread_pool_worker, &item)) _thread_pool_run(&_thread_pool_worker, &item);
+        else _mm_pause();
+    }
+
+    atomic_add(&pool->active_jobs, -1);
+    if(is_external) {
+        _thread_pool_worker = saved;
+        spin_unlock(&pool->external_lock);
+    }
+}
+void parallel_range_chunks(s64 min_index, s64 max_index, s64 grain, ParallelRangeFunction function, void* data) { parallel_range_chunks(thread_pool_default(), min_index, max_index, grain, function, data); }
+
+// body(begin, end) for each piece of the range
+template<typename F>
+void parallel_range_chunks(ThreadPool* pool, s64 min_index, s64 max_index, s64 grain, F body) {
+    parallel_range_chunks(pool, min_index, max_index, grain, [](s64 begin, s64 end, void* data) { (*(F*)data)(begin, end); }, &body);
+}
+template<typename F> void parallel_range_chunks(s64 min_index, s64 max_index, s64 grain, F body) { parallel_range_chunks(thread_pool_default(), min_index, max_index, grain, body); }
+
+// body(i) for each index of the range
+template<typename F>
+void parallel_range(ThreadPool* pool, s64 min_index, s64 max_index, s64 grain, F body) {
+    parallel_range_chunks(pool, min_index, max_index, grain, [&body](s64 begin, s64 end) {
+        for(s64 i = begin; i < end; i++) body(i);
+    });
+}
+template<typename F> void parallel_range(s64 min_index, s64 max_index, s64 grain, F body) { parallel_range(thread_pool_default(), min_index, max_index, grain, body); }
+template<typename F> void parallel_range(s64 min_index, s64 max_index, F body) { parallel_range(thread_pool_default(), min_index, max_index, 0, body); }
+
+template<typename T>
+struct _ParallelFor {
+    T* ptr;
+    s32 size;
+    s64 grain;
+};
+
+template<typename T> _ParallelFor<T> _make_parallel_for(T* ptr, s32 size, s64 grain) { return {ptr, size, grain}; }
+
+template<typename T, typename F>
+void operator +(_ParallelFor<T> array, F body) {
+    parallel_range(0, array.size, array.grain, [&](s64 i) { body(array.ptr + i, (s32)i); });
+}
+
+// like For_ptr, but each element can be processed on a different thread, grain can be 0 (see parallel_range_chunks)
+#define ParallelFor(arr, grain) _make_parallel_for((arr).ptr, (arr).size, grain) + [&](decltype((arr).ptr) it, s32 it_index)
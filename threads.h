@@ -0,0 +1,151 @@
+#pragma once
+#define GYO_THREADS
+
+/*
+In this file:
+- atomic_* functions, thin wrappers around the compiler intrinsics, so structs using them can stay simple (and copyable)
+- SpinLock, the simplest possible lock, useful to protect very small critical sections
+- Thread, to start/join os threads (CreateThread on windows, pthreads everywhere else)
+*/
+
+#ifndef GYOFIRST
+    #include "first.h"
+#endif
+
+#ifndef DISABLE_INCLUDES
+    #include <emmintrin.h> // for _mm_pause
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #endif
+    #ifdef _WIN32
+        #include <windows.h>
+    #else
+        #include <pthread.h>
+        #include <sched.h>  // for sched_yield
+        #include <unistd.h> // for usleep
+    #endif
+#endif
+
+// every atomic operation is sequentially consistent and returns the value *before* the operation (loads are acquire)
+#ifdef _MSC_VER
+inline s32 atomic_exchange(volatile s32* dest, s32 value) { return _InterlockedExchange((volatile long*)dest, value); }
+inline s64 atomic_exchange(volatile s64* dest, s64 value) { return _InterlockedExchange64((volatile long long*)dest, value); }
+inline s32 atomic_add(volatile s32* dest, s32 value) { return _InterlockedExchangeAdd((volatile long*)dest, value); }
+inline s64 atomic_add(volatile s64* dest, s64 value) { return _InterlockedExchangeAdd64((volatile long long*)dest, value); }
+inline s32 atomic_compare_exchange(volatile s32* dest, s32 expected, s32 desired) { return _InterlockedCompareExchange((volatile long*)dest, desired, expected); }
+inline s64 atomic_compare_exchange(volatile s64* dest, s64 expected, s64 desired) { return _InterlockedCompareExchange64((volatile long long*)dest, desired, expected); }
+inline s32 atomic_load(volatile s32* src) { return *src; } // on x86 msvc volatile reads already have acquire semantics
+inline s64 atomic_load(volatile s64* src) { return *src; }
+inline void atomic_store(volatile s32* dest, s32 value) { _InterlockedExchange((volatile long*)dest, value); }
+inline void atomic_store(volatile s64* dest, s64 value) { _InterlockedExchange64((volatile long long*)dest, value); }
+inline void atomic_fence() { _mm_mfence(); } // full barrier, no load/store moves across it
+#else
+inline s32 atomic_exchange(volatile s32* dest, s32 value) { return __atomic_exchange_n(dest, value, __ATOMIC_SEQ_CST); }
+inline s64 atomic_exchange(volatile s64* dest, s64 value) { return __atomic_exchange_n(dest, value, __ATOMIC_SEQ_CST); }
+inline s32 atomic_add(volatile s32* dest, s32 value) { return __atomic_fetch_add(dest, value, __ATOMIC_SEQ_CST); }
+inline s64 atomic_add(volatile s64* dest, s64 value) { return __atomic_fetch_add(dest, value, __ATOMIC_SEQ_CST); }
+inline s32 atomic_compare_exchange(volatile s32* dest, s32 expected, s32 desired) { __atomic_compare_exchange_n(dest, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST); return expected; }
+inline s64 atomic_compare_exchange(volatile s64* dest, s64 expected, s64 desired) { __atomic_compare_exchange_n(dest, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST); return expected; }
+inline s32 atomic_load(volatile s32* src) { return __atomic_load_n(src, __ATOMIC_ACQUIRE); }
+inline s64 atomic_load(volatile s64* src) { return __atomic_load_n(src, __ATOMIC_ACQUIRE); }
+inline void atomic_store(volatile s32* dest, s32 value) { __atomic_store_n(dest, value, __ATOMIC_RELEASE); } // stores are release
+inline void atomic_store(volatile s64* dest, s64 value) { __atomic_store_n(dest, value, __ATOMIC_RELEASE); }
+inline void atomic_fence() { __atomic_thread_fence(__ATOMIC_SEQ_CST); } // full barrier, no load/store moves across it
+#endif
+
+//
+// SpinLock, zero initialized means unlocked.
+// Threads waiting for the lock keep spinning instead of going to sleep, so only use it
+// when the lock is held for a very short time (a few hundred cycles), else a mutex is better.
+//
+struct SpinLock {
+    volatile s32 locked = 0;
+};
+
+inline bool spin_try_lock(SpinLock* l) { return atomic_exchange(&l->locked, 1) == 0; }
+
+inline void spin_lock(SpinLock* l) {
+    while(true) {
+        if(spin_try_lock(l)) return;
+        while(atomic_load(&l->locked)) _mm_pause(); // wait with plain reads, so we don't keep stealing the cache line from the owner
+    }
+}
+
+inline void spin_unlock(SpinLock* l) {
+    ASSERT(atomic_load(&l->locked), "unlocking a SpinLock which was not locked");
+    atomic_exchange(&l->locked, 0);
+}
+
+//
+// Thread, a handle to an os thread running a function of yours.
+// Example:
+// Thread t = thread_start([](void* data) { ... }, &my_data); // lambdas without captures work too
+// thread_join(&t);
+//
+typedef void (*ThreadFunction)(void* data);
+
+struct Thread {
+    u64 handle; // HANDLE on windows, pthread_t everywhere else
+};
+
+struct _ThreadStart {
+    ThreadFunction function;
+    void* data;
+};
+
+#ifdef _WIN32
+DWORD WINAPI _thread_entry(LPVOID param) {
+    _ThreadStart start = *(_ThreadStart*)param;
+    free(param);
+    start.function(start.data);
+    return 0;
+}
+
+Thread thread_start(ThreadFunction function, void* data) {
+    auto* start = (_ThreadStart*)malloc(sizeof(_ThreadStart)); // the new thread frees it, we might return before it starts
+    start->function = function;
+    start->data = data;
+    Thread t = {};
+    t.handle = (u64)CreateThread(NULL, 0, _thread_entry, start, 0, NULL);
+    ASSERT_ALWAYS(t.handle != 0, "couldn't start a new thread");
+    return t;
+}
+
+void thread_join(Thread* t) {
+    WaitForSingleObject((HANDLE)t->handle, INFINITE);
+    CloseHandle((HANDLE)t->handle);
+    t->handle = 0;
+}
+
+inline void thread_yield() { SwitchToThread(); }
+inline void thread_sleep_ms(s32 ms) { Sleep(ms); }
+inline s32 get_cpu_count() { SYSTEM_INFO info; GetSystemInfo(&info); return info.dwNumberOfProcessors; }
+#else
+void* _thread_entry(void* param) {
+    _ThreadStart start = *(_ThreadStart*)param;
+    free(param);
+    start.function(start.data);
+    return NULL;
+}
+
+Thread thread_start(ThreadFunction function, void* data) {
+    auto* start = (_ThreadStart*)malloc(sizeof(_ThreadStart)); // the new thread frees it, we might return before it starts
+    start->function = function;
+    start->data = data;
+    pthread_t handle;
+    int error = pthread_create(&handle, NULL, _thread_entry, start);
+    ASSERT_ALWAYS(error == 0, "couldn't start a new thread (error %)", error);
+    Thread t = {};
+    t.handle = (u64)handle;
+    return t;
+}
+
+void thread_join(Thread* t) {
+    pthread_join((pthread_t)t->handle, NULL);
+    t->handle = 0;
+}
+
+inline void thread_yield() { sched_yield(); }
+inline void thread_sleep_ms(s32 ms) { usleep(ms * 1000); }
+inline s32 get_cpu_count() { return (s32)sysconf(_SC_NPROCESSORS_ONLN); }
+#endif
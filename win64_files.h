@@ -7,7 +7,7 @@ functions to simplify working with windows' file system.
 - get_only_folders_in_dir(...) to know which folders only are in a directory
 - get_drive_names(...) to know which drives you have in your pc
 - win64_get_last_write_time(...) to know when a file was last edited
-- win64_write_file(...) to write data to a file
+- win64_write_file(...) to write data (or a StrBuilder) to a file
 - win64_read_entire_file(...) to read the entire contents of a file
 */
 
@@ -177,6 +177,24 @@ bool win64_write_file(const char* filename, u8* file_data, u32 data_size) {
     return true;
 }
 
+// Same as above, but writes the content of a StrBuilder, one chunk at a time if it's a chunked builder (so it's never copied).
+bool win64_write_file(const char* filename, StrBuilder* b) {
+    auto file_handle = CreateFileA(filename, GENERIC_WRITE, 0, 0, CREATE_ALWAYS, 0, 0);
+    if (file_handle == INVALID_HANDLE_VALUE) return false;
+    defer {
+        bool ok = CloseHandle(file_handle);
+        ASSERT(ok, "couldn't close file");
+    };
+
+    StrBuilderChunk* it = NULL;
+    str chunk;
+    while(str_builder_next_chunk(b, &it, &chunk)) {
+        DWORD bytes_written;
+        if(!WriteFile(file_handle, chunk.ptr, chunk.size, &bytes_written, 0)) return false;
+    }
+    return true;
+}
+
 
 // Reads the file size of the given file name.
 // If the functions succeeds returns the file handle which should be closed later and sets the out_file_size pointer.